@@ -14,16 +14,27 @@
 #include <random>
 #include <type_traits>
 #include <functional>
+#include <map>
+#include <array>
+#include <system_error>
 
 #if defined(_MSC_VER)
 	#include <intrin.h>
+#elif defined(__GNUG__) && defined(__x86_64__)
+	#include <x86intrin.h>
 #endif
 
 #include "BigIntException.h"
+#include "BigIntNTT.h"
+#include "BigIntThreads.h"
+#include "BigIntThresholds.h"
+#include "BigIntAllocator.h"
+#include "BigIntSmallVector.h"
 
 namespace BigIntUtility {
 
-#define __BIGINT_PASTER2(x) template <> struct uint_t< x > { typedef  uint ## x ## _t type;}
+#define __BIGINT_PASTER2(x) template <> struct uint_t< x > { typedef  uint ## x ## _t type;}; \
+			template <> struct int_t< x > { typedef  int ## x ## _t type;}
 #define __BIGINT_EVALUATOR2(x)  __BIGINT_PASTER2(x)
 #define __BIGINT_UINT_STRUCT(SIZE)  __BIGINT_EVALUATOR2(SIZE)
 
@@ -58,13 +69,16 @@ namespace BigIntUtility {
 	}
 
 	template <int bits> struct uint_t {};
+	template <int bits> struct int_t {};
 	__BIGINT_UINT_STRUCT(8);
 	__BIGINT_UINT_STRUCT(16);
 	__BIGINT_UINT_STRUCT(32);
 	__BIGINT_UINT_STRUCT(64);
 
+	//std::make_signed and std::numeric_limits don't know 128-bit types in strict ISO mode
 #if defined(__SIZEOF_INT128__)
-	template <> struct uint_t< 128 > { typedef unsigned __int128 type; }
+	template <> struct uint_t< 128 > { typedef unsigned __int128 type; };
+	template <> struct int_t< 128 > { typedef __int128 type; };
 #endif
 
     template<typename T>
@@ -79,17 +93,21 @@ namespace BigIntUtility {
 	__BIGINT_CARRY_FUNCTION(subborrow, 16);
 	__BIGINT_CARRY_FUNCTION(subborrow, 32);
 
-//#elif defined(__GNUG__)
-//    __BIGINT_CARRY_FUNCTION_GCC_ADD(addcarry, 8);
-//    __BIGINT_CARRY_FUNCTION_GCC_SUB(subborrow, 8);
-//    __BIGINT_CARRY_FUNCTION_GCC_ADD(addcarry, 16);
-//    __BIGINT_CARRY_FUNCTION_GCC_SUB(subborrow, 16);
-//    __BIGINT_CARRY_FUNCTION_GCC_ADD(addcarry, 32);
-//    __BIGINT_CARRY_FUNCTION_GCC_SUB(subborrow, 32);
-//	#if defined(__SIZEOF_INT128__)
-//		__BIGINT_CARRY_FUNCTION_GCC_ADD(addcarry, 64);
-//		__BIGINT_CARRY_FUNCTION_GCC_SUB(subborrow, 64);
-//	#endif
+#elif defined(__GNUG__) && defined(__x86_64__)
+	//GCC has no 8 and 16 bit adc intrinsics, its overflow builtins are compiled to the same code
+	__BIGINT_CARRY_FUNCTION_GCC_ADD(addcarry, 8);
+	__BIGINT_CARRY_FUNCTION_GCC_SUB(subborrow, 8);
+	__BIGINT_CARRY_FUNCTION_GCC_ADD(addcarry, 16);
+	__BIGINT_CARRY_FUNCTION_GCC_SUB(subborrow, 16);
+	__BIGINT_CARRY_FUNCTION(addcarry, 32);
+	__BIGINT_CARRY_FUNCTION(subborrow, 32);
+	//uint64_t is unsigned long here, while the intrinsics take unsigned long long
+	template<> inline unsigned char addcarry<uint64_t>(unsigned char carry, uint64_t a, uint64_t b, uint64_t * res) {
+		return _addcarry_u64(carry, a, b, (unsigned long long *)res);
+	}
+	template<> inline unsigned char subborrow<uint64_t>(unsigned char borrow, uint64_t a, uint64_t b, uint64_t * res) {
+		return _subborrow_u64(borrow, a, b, (unsigned long long *)res);
+	}
 
 #else
 	template<typename T>
@@ -107,9 +125,34 @@ namespace BigIntUtility {
 		return borrow + (a < b);
 	}
 #endif
+
+	//results of BigInt_t::to_chars and from_chars as the ones of std::to_chars and std::from_chars:
+	//the end of the written or read characters and std::errc() on success
+	struct to_chars_result {
+		char * ptr;
+		std::errc ec;
+	};
+	struct from_chars_result {
+		const char * ptr;
+		std::errc ec;
+	};
 }
 
-template <int SIZE = 32 >
+//64-bit limbs are the default where the compiler has 128-bit integers for double limbs
+#if defined(__SIZEOF_INT128__)
+	#define __BIGINT_DEFAULT_SIZE 64
+#else
+	#define __BIGINT_DEFAULT_SIZE 32
+#endif
+
+template <int SIZE = __BIGINT_DEFAULT_SIZE, class ALLOC = BigIntUtility::HeapAllocator > class BigIntDivisor;
+template <int SIZE = __BIGINT_DEFAULT_SIZE, class ALLOC = BigIntUtility::HeapAllocator > class BigIntMontgomery;
+template <int SIZE = __BIGINT_DEFAULT_SIZE > class BigIntReader;
+template <int SIZE = __BIGINT_DEFAULT_SIZE > class BigIntWriter;
+template <unsigned BITS, int SIZE = __BIGINT_DEFAULT_SIZE > class FixedBigInt;
+
+//SIZE is the size of limbs in bits, ALLOC is the allocator of limbs, see BigIntAllocator.h
+template <int SIZE = __BIGINT_DEFAULT_SIZE, class ALLOC = BigIntUtility::HeapAllocator >
 class BigInt_t {
 	static_assert(
 		SIZE == 8 || SIZE == 16 || SIZE == 32 || SIZE == 64,
@@ -118,12 +161,14 @@ public:
 	//types used by this class
 	typedef typename BigIntUtility::uint_t<SIZE>::type		bui;
 	typedef typename BigIntUtility::uint_t<SIZE * 2>::type	lui;
-	typedef typename std::make_signed<bui>::type			bsi;
-	typedef typename std::make_signed<lui>::type			lsi;
+	typedef typename BigIntUtility::int_t<SIZE>::type		bsi;
+	typedef typename BigIntUtility::int_t<SIZE * 2>::type	lsi;
 
 	//service types
-	typedef std::pair<BigInt_t<SIZE>, BigInt_t<SIZE>> QuRem;
+	typedef std::pair<BigInt_t<SIZE, ALLOC>, BigInt_t<SIZE, ALLOC>> QuRem;
 	typedef std::vector<bui> intvec;
+	//digits of a number, up to 256 bits are kept in the object itself without allocations
+	typedef BigIntUtility::SmallVector<bui, 256 / SIZE, ALLOC> limbvec;
 
 	//pointers to array of basic type
 	typedef bui *			buip;
@@ -137,11 +182,56 @@ public:
 	//2^SOI - 1
 	static const lui C_MAX_DIG = (lui)std::numeric_limits<bui>::max();
 	static const unsigned char LOG_SOI = BigIntUtility::_log2(SOI);
+	//crossover sizes of algorithms, see BigIntThresholds.h. The tune program (BIGINT_TUNE) changes them at runtime
+#if defined(BIGINT_TUNE)
+	static unsigned int KARATSUBA_LIMIT;
+	static unsigned int TOOM3_LIMIT;
+	static unsigned int TOOM4_LIMIT;
+	static unsigned int NTT_LIMIT;
+	static unsigned int SQR_KARATSUBA_LIMIT;
+	static unsigned int SQR_TOOM3_LIMIT;
+	static unsigned int SQR_TOOM4_LIMIT;
+	static unsigned int SQR_NTT_LIMIT;
+	static unsigned int DIV_BZ_LIMIT;
+	static unsigned int DIV_NEWTON_LIMIT;
+	static unsigned int DIVEXACT_LIMIT;
+	static unsigned int TO_STRING_DC_LIMIT;
+	static unsigned int FROM_STRING_DC_LIMIT;
+#else
 	//approximate size of inernal vector on which Karatsuba multiplication is as effective as naive
-	static const unsigned int KARATSUBA_LIMIT = 55;
+	static const unsigned int KARATSUBA_LIMIT = BigIntUtility::thresholds<SIZE>::KARATSUBA_LIMIT;
+	//approximate size of inernal vector on which Toom-3 multiplication is as effective as Karatsuba
+	static const unsigned int TOOM3_LIMIT = BigIntUtility::thresholds<SIZE>::TOOM3_LIMIT;
+	//approximate size of inernal vector on which Toom-4 multiplication is as effective as Toom-3
+	static const unsigned int TOOM4_LIMIT = BigIntUtility::thresholds<SIZE>::TOOM4_LIMIT;
+	//approximate size of inernal vector on which NTT multiplication is as effective as Toom-4
+	static const unsigned int NTT_LIMIT = BigIntUtility::thresholds<SIZE>::NTT_LIMIT;
+	//the same limits for squaring
+	static const unsigned int SQR_KARATSUBA_LIMIT = BigIntUtility::thresholds<SIZE>::SQR_KARATSUBA_LIMIT;
+	static const unsigned int SQR_TOOM3_LIMIT = BigIntUtility::thresholds<SIZE>::SQR_TOOM3_LIMIT;
+	static const unsigned int SQR_TOOM4_LIMIT = BigIntUtility::thresholds<SIZE>::SQR_TOOM4_LIMIT;
+	static const unsigned int SQR_NTT_LIMIT = BigIntUtility::thresholds<SIZE>::SQR_NTT_LIMIT;
+	//size of divisor and quotient from which Burnikel-Ziegler division is faster than the long one
+	static const unsigned int DIV_BZ_LIMIT = BigIntUtility::thresholds<SIZE>::DIV_BZ_LIMIT;
+	//size of divisor and quotient from which division by Newton reciprocal is faster than Burnikel-Ziegler
+	static const unsigned int DIV_NEWTON_LIMIT = BigIntUtility::thresholds<SIZE>::DIV_NEWTON_LIMIT;
+	//size of divisor and quotient from which exact division is done by the general one instead of Hensel's
+	static const unsigned int DIVEXACT_LIMIT = BigIntUtility::thresholds<SIZE>::DIVEXACT_LIMIT;
+	//length of numbers from which to_string splits them by powers of the base
+	static const unsigned int TO_STRING_DC_LIMIT = BigIntUtility::thresholds<SIZE>::TO_STRING_DC_LIMIT;
+	//length of numbers from which strings are parsed by halves joined with powers of the base
+	static const unsigned int FROM_STRING_DC_LIMIT = BigIntUtility::thresholds<SIZE>::FROM_STRING_DC_LIMIT;
+#endif
+	//length of the longest power of the base kept by radix_powers and radix_divisors between conversions
+	static const size_t RADIX_CACHE_LIMIT = 1 << 15;
+
+	//multiplication algorithms. AUTO chooses the algorithm by the length of operands
+	enum class MultMethod {
+		AUTO, SCHOOLBOOK, KARATSUBA, TOOM3, TOOM4, NTT, TOOM32, TOOM42
+	};
 
 	//constant 1
-	static const BigInt_t<SIZE> C_1;
+	static const BigInt_t<SIZE, ALLOC> C_1;
 
 	//returns the sign of signed number
 	template<typename signed_int>
@@ -171,19 +261,19 @@ public:
 private:
 	//the only nonstatic members: signum of this BigInt_t and its digits
 	char sgn;
-	intvec data;
+	limbvec data;
 
 	//normalize
-	BigInt_t<SIZE> & normalize();
+	BigInt_t<SIZE, ALLOC> & normalize();
 	//returns pointer to internal vector storage
 	buip get_ptr();
 	buicp get_ptr() const;
 
 public:
 	// a = |a| + |b|
-	static BigInt_t<SIZE> & addAbs(BigInt_t<SIZE> & a, const BigInt_t<SIZE> & b, long long bigShiftB = 0);
+	static BigInt_t<SIZE, ALLOC> & addAbs(BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b, long long bigShiftB = 0);
 	// a = |a| - |b|
-	static BigInt_t<SIZE> & subAbs(BigInt_t<SIZE> & a, const BigInt_t<SIZE> & b, long long bigShiftB = 0);
+	static BigInt_t<SIZE, ALLOC> & subAbs(BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b, long long bigShiftB = 0);
 private:
 	inline static unsigned char addcarry(unsigned char carry, bui a, bui b, bui * res) {
 		return BigIntUtility::addcarry<bui>(carry, a, b, res);
@@ -193,12 +283,149 @@ private:
 	}
 
 	// a = a + sign * b
-	static BigInt_t<SIZE> & addSign(BigInt_t<SIZE> & a, const BigInt_t<SIZE> & b, char sign);
+	static BigInt_t<SIZE, ALLOC> & addSign(BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b, char sign);
 
 	//pointer versions of multiplication, addAbs, subAbs. MUST HAVE for optimization purposes
-	static BigInt_t<SIZE> mult(buicp a1, buicp a2, buicp b1, buicp b2, char res_sign);
-	static BigInt_t<SIZE> & add_abs_ptr(BigInt_t<SIZE> & a, buicp b, buicp be, long long bigShiftB = 0);
-	static BigInt_t<SIZE> & sub_abs_ptr(BigInt_t<SIZE> & a, buicp b, buicp be, long long bigShiftB = 0);
+	static BigInt_t<SIZE, ALLOC> mult(buicp a1, buicp a2, buicp b1, buicp b2, char res_sign);
+	static BigInt_t<SIZE, ALLOC> mult_school(buicp a1, buicp a2, buicp b1, buicp b2);
+	static BigInt_t<SIZE, ALLOC> mult_karatsuba(buicp a1, buicp a2, buicp b1, buicp b2);
+	static BigInt_t<SIZE, ALLOC> mult_toom3(buicp a1, buicp a2, buicp b1, buicp b2);
+	static BigInt_t<SIZE, ALLOC> mult_toom4(buicp a1, buicp a2, buicp b1, buicp b2);
+	//unbalanced Toom for the lengths of operands in ratio about 3:2 (Toom-2.5) and 2:1
+	static BigInt_t<SIZE, ALLOC> mult_toom32(buicp a1, buicp a2, buicp b1, buicp b2);
+	static BigInt_t<SIZE, ALLOC> mult_toom42(buicp a1, buicp a2, buicp b1, buicp b2);
+	//r[0, k + l) = a * b, where k and l are the lengths of [a1, a2) and [b1, b2). r doesn't overlap a and b
+	static void mult_to(buip r, buicp a1, buicp a2, buicp b1, buicp b2);
+	static BigInt_t<SIZE, ALLOC> mult_ntt(buicp a1, buicp a2, buicp b1, buicp b2);
+	//pointer versions of squaring. mult_* functions square if [a1, a2) and [b1, b2) are the same
+	static BigInt_t<SIZE, ALLOC> sqr(buicp a1, buicp a2);
+	static BigInt_t<SIZE, ALLOC> sqr_school(buicp a1, buicp a2);
+	static BigInt_t<SIZE, ALLOC> & add_abs_ptr(BigInt_t<SIZE, ALLOC> & a, buicp b, buicp be, long long bigShiftB = 0);
+	static BigInt_t<SIZE, ALLOC> & sub_abs_ptr(BigInt_t<SIZE, ALLOC> & a, buicp b, buicp be, long long bigShiftB = 0);
+
+	//limb array kernels. r may be equal to a or b, the result has n limbs
+	// r = a + b, returns carry
+	static bui add_n(buip r, buicp a, buicp b, size_t n);
+	// r = a - b, returns borrow
+	static bui sub_n(buip r, buicp a, buicp b, size_t n);
+	// r = a + c, returns carry
+	static bui add_1(buip r, buicp a, size_t n, bui c);
+	// r[0, n) = |a[0, n) - b[0, m)|, m <= n. Returns true if a < b
+	static bool abs_diff(buip r, buicp a, size_t n, buicp b, size_t m);
+	// a[0, n) <=> b[0, n)
+	static char cmp_n(buicp a, buicp b, size_t n);
+	// r[0, n) = a[0, n) * b + c, returns carry limb
+	static bui mul_1(buip r, buicp a, size_t n, bui b, bui c = 0);
+	// r[0, n) += a[0, n) * b, returns carry limb
+	static bui addmul_1(buip r, buicp a, size_t n, bui b);
+	// r[0, n) -= a[0, n) * b, returns borrow limb
+	static bui submul_1(buip r, buicp a, size_t n, bui b);
+	// r[0, k + l) = a[0, k) * b[0, l). r doesn't overlap a and b
+	static void mul_basecase(buip r, buicp a, size_t k, buicp b, size_t l);
+	// r[0, 2n) = a[0, n)^2. r doesn't overlap a
+	static void sqr_basecase(buip r, buicp a, size_t n);
+	//Karatsuba recursion in a scratch buffer ws of kara_scratch(k, par) limbs, k >= l.
+	//If par is set the products of the top level are computed in parallel
+	static void kara_mul(buip r, buicp a, size_t k, buicp b, size_t l, buip ws, bool par = false);
+	static void kara_sqr(buip r, buicp a, size_t n, buip ws, bool par = false);
+	static size_t kara_scratch(size_t k, bool par = false);
+
+	//checks if the products of n-limb operands should be computed in parallel
+	static bool parallel(size_t n);
+	// res[i] = *x[i] * *y[i], i < cnt. In parallel if par is set
+	static void mult_many(BigInt_t<SIZE, ALLOC> * res, const BigInt_t<SIZE, ALLOC> * const * x, const BigInt_t<SIZE, ALLOC> * const * y, size_t cnt, bool par);
+
+	//returns i-th piece of length len of [a, ae) as a positive BigInt_t
+	static BigInt_t<SIZE, ALLOC> piece(buicp a, buicp ae, size_t i, size_t len);
+	// q = a / d, returns a % d. q may be equal to a
+	static bui div_1(buip q, buicp a, size_t n, bui d);
+	//the same for dn = d << s with the highest bit set and its reciprocal v
+	static bui div_1_preinv(buip q, buicp a, size_t n, bui dn, bui v, int s);
+	//Moller-Granlund reciprocal of d with the highest bit set: floor((B^2 - 1) / d) - B
+	static bui reciprocal_1(bui d);
+	// <u1, u0> / d by the reciprocal v of d, u1 < d. Returns the quotient, u1 becomes the remainder
+	static bui div_limb_preinv(bui & u1, bui u0, bui d, bui v);
+	//reciprocal of <d1, d0> with the highest bit of d1 set: floor((B^3 - 1) / (d1 B + d0)) - B
+	static bui reciprocal_2(bui d1, bui d0);
+	//reciprocal_2 of the two highest limbs of d (reciprocal_1 if d has one limb)
+	static bui reciprocal_top(const BigInt_t<SIZE, ALLOC> & d);
+	// <n2, n1, n0> / <d1, d0> by the reciprocal v of <d1, d0>, <n2, n1> < <d1, d0>.
+	//Returns the quotient, <r1, r0> is the remainder
+	static bui div_3by2_preinv(bui n2, bui n1, bui n0, bui d1, bui d0, bui v, bui & r1, bui & r0);
+	// a = a / d, where a is known to be divisible by d
+	static BigInt_t<SIZE, ALLOC> & div_exact_1(BigInt_t<SIZE, ALLOC> & a, bui d);
+	//inverse of odd d modulo B
+	static bui inverse_1(bui d);
+	// r = r + sign * [a, a + n) * [b, b + m). r doesn't overlap a and b
+	static BigInt_t<SIZE, ALLOC> & mul_acc(BigInt_t<SIZE, ALLOC> & r, buicp a, size_t n, buicp b, size_t m, char sign);
+	//wrap-around products for results known to be short: r[0, N) = [a, a + k) * [b, b + l) mod (B^N - 1) for the returned
+	//N >= n, k, l <= n. From NTT_LIMIT limbs it is a cyclic NTT of half the length of the whole product, below the whole
+	//product is folded
+	static size_t mult_wrap(intvec & r, size_t n, buicp a, size_t k, buicp b, size_t l);
+	// r[0, N) = r[0, N) + a[0, len) mod (B^N - 1), len <= N
+	static void add_wrap(buip r, size_t N, buicp a, size_t len);
+	//the number x with |x| < B^N / 2 which is equal to r[0, N) modulo B^N - 1
+	static BigInt_t<SIZE, ALLOC> from_wrap(const intvec & r);
+
+	//division of positive numbers, the highest bit of d is set. q = r / d, r = r % d.
+	//div_abs chooses the method by the lengths of d and q
+	static void div_abs(BigInt_t<SIZE, ALLOC> & r, const BigInt_t<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & q);
+	//long division, v = reciprocal_top(d)
+	static void div_school(BigInt_t<SIZE, ALLOC> & r, const BigInt_t<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & q, bui v);
+	// q[0, k - l] = r[0, k) / d[0, l), r[0, l) = r % d, l >= 2. v = reciprocal_2(d[l - 1], d[l - 2])
+	static void div_school_n(buip q, buip r, size_t k, buicp d, size_t l, bui v);
+	static void div_bz(BigInt_t<SIZE, ALLOC> & r, const BigInt_t<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & q);
+	static void div_newton(BigInt_t<SIZE, ALLOC> & r, const BigInt_t<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & q);
+	//Burnikel-Ziegler steps: r < d * B^n for d of 2n limbs (2n by n division) and of 2h limbs (3h by 2h)
+	static void div_2by1(BigInt_t<SIZE, ALLOC> & r, const BigInt_t<SIZE, ALLOC> & d, size_t n, BigInt_t<SIZE, ALLOC> & q);
+	static void div_3by2(BigInt_t<SIZE, ALLOC> & r, const BigInt_t<SIZE, ALLOC> & d, size_t h, BigInt_t<SIZE, ALLOC> & q);
+	// hi = hi * B^h + lo, lo < B^h
+	static BigInt_t<SIZE, ALLOC> & shift_add(BigInt_t<SIZE, ALLOC> & hi, const BigInt_t<SIZE, ALLOC> & lo, size_t h);
+	//floor(B^(2m) / d) up to a few units, d has m limbs and its highest bit set, B = 2^SOI
+	static BigInt_t<SIZE, ALLOC> reciprocal(const BigInt_t<SIZE, ALLOC> & d);
+	//division by the reciprocal x of d, r < B^(2m) where d has m limbs
+	static void div_barrett(BigInt_t<SIZE, ALLOC> & r, const BigInt_t<SIZE, ALLOC> & d, const BigInt_t<SIZE, ALLOC> & x, BigInt_t<SIZE, ALLOC> & q);
+	//the same for any r, which is divided by pieces of m limbs
+	static void div_barrett_blocks(BigInt_t<SIZE, ALLOC> & r, const BigInt_t<SIZE, ALLOC> & d, const BigInt_t<SIZE, ALLOC> & x, BigInt_t<SIZE, ALLOC> & q);
+	//turns the quotient and remainder of |a| / |d| into the ones of a / d, sa is the sign of a
+	static void div_signs(char sa, const BigInt_t<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & q, BigInt_t<SIZE, ALLOC> & r);
+
+	//powers base^(c 2^i) of the base, c digits fill a limb, until the last one has more than (n + 1) / 2 limbs.
+	//The powers up to RADIX_CACHE_LIMIT limbs are cached per thread. If longer ones are needed, the tree
+	//is copied to top and completed there, so that they are freed with top after the conversion.
+	//Numbers with other allocators use the ones of the default allocator
+	static const std::vector<BigInt_t<SIZE, ALLOC>> & radix_powers(bui base, size_t n, std::vector<BigInt_t<SIZE, ALLOC>> & top);
+	//the same powers prepared for division
+	static const std::vector<BigIntDivisor<SIZE, ALLOC>> & radix_divisors(bui base, size_t n, std::vector<BigIntDivisor<SIZE, ALLOC>> & top);
+	//writes |a| to [s, s + len) with leading zeros, a is destroyed. Returns false if a >= base^len.
+	//Divide-and-conquer by the powers pw of the base from TO_STRING_DC_LIMIT limbs, c digits of a chunk in the basecase
+	static bool write_digits(char * s, size_t len, BigInt_t<SIZE, ALLOC> & a, bui base, unsigned c, const std::vector<BigIntDivisor<SIZE, ALLOC>> & pw);
+	//the same for the limbs [p, p + n) by chunks of c digits, power = base^c. The limbs are destroyed
+	static bool write_digits_basecase(char * s, size_t len, buip p, size_t n, bui base, unsigned c, bui power);
+	//the number written by the len digits [s, s + len). Divide-and-conquer by the powers pw
+	//of the base from FROM_STRING_DC_LIMIT limbs, chunks of c digits in the basecase
+	static BigInt_t<SIZE, ALLOC> read_digits(const char * s, size_t len, bui base, unsigned c, const std::vector<BigInt_t<SIZE, ALLOC>> & pw);
+	//the same by chunks of c digits to res, power = base^c. The limbs of res are reused
+	static void read_digits_basecase(BigInt_t<SIZE, ALLOC> & res, const char * s, size_t len, bui base, unsigned c, bui power);
+	//returns k if base = 2^k, otherwise 0
+	static unsigned pow2_base(bui base);
+	//conversions for base 2^k without arithmetic: each digit is a slice of k bits of the limbs.
+	//write_digits_pow2 writes all the digits of |a| to [s, s + len), len = ceil(bits / k)
+	static void write_digits_pow2(char * s, size_t len, const BigInt_t<SIZE, ALLOC> & a, unsigned k);
+	static void read_digits_pow2(BigInt_t<SIZE, ALLOC> & res, const char * s, size_t len, unsigned k);
+	// *this = the positive number written by the len digits [s, s + len), the method is chosen by base and len
+	void assign_digits(const char * s, size_t len, unsigned base);
+	//values of characters as digits, 0xFF for the other characters
+	static const std::array<unsigned char, 256> & digit_values();
+	//count of bits of |*this|
+	size_t bit_length() const;
+
+	template<int _SIZE, class _ALLOC> friend class BigIntDivisor;
+	template<int _SIZE, class _ALLOC> friend class BigIntMontgomery;
+	template<int _SIZE> friend class BigIntReader;
+	template<int _SIZE> friend class BigIntWriter;
+	template<int _SIZE, class _ALLOC> friend class BigInt_t;
+	template<unsigned _BITS, int _SIZE> friend class FixedBigInt;
 
 	//indexing operators - return references to elements of data
 	inline bui & operator[] (size_t i) {
@@ -210,34 +437,38 @@ private:
 
 public:
 	//different constructors
-	BigInt_t(char sgn, const intvec & data) :sgn(sgn), data(data) {}
-	BigInt_t(char sgn, const BigInt_t<SIZE> & a) :sgn(sgn), data(a.data) {}
-	BigInt_t(const BigInt_t<SIZE> & a) : sgn(a.sgn), data(a.data) {}
-	BigInt_t(BigInt_t<SIZE> && a) : sgn(a.sgn), data(std::move(a.data)) {}
+	BigInt_t(char sgn, const intvec & data) :sgn(sgn), data(data.begin(), data.end()) {}
+	BigInt_t(char sgn, const BigInt_t<SIZE, ALLOC> & a) :sgn(sgn), data(a.data) {}
+	BigInt_t(const BigInt_t<SIZE, ALLOC> & a) : sgn(a.sgn), data(a.data) {}
+	BigInt_t(BigInt_t<SIZE, ALLOC> && a) : sgn(a.sgn), data(std::move(a.data)) {}
+	//the same number with limbs in memory of another allocator
+	template<class _ALLOC>
+	explicit BigInt_t(const BigInt_t<SIZE, _ALLOC> & a) : sgn(a.sgn), data(a.data.begin(), a.data.end()) {}
 	BigInt_t(unsigned long long val, char sign);
-	BigInt_t(signed long long val = 0L) : BigInt_t<SIZE>(abs_num(val), sign(val)) {}
-	BigInt_t(const std::string & val, unsigned inB = BigInt_t<SIZE>::inputBase);
+	BigInt_t(signed long long val = 0L) : BigInt_t<SIZE, ALLOC>(abs_num(val), sign(val)) {}
+	BigInt_t(const std::string & val, unsigned inB = BigInt_t<SIZE, ALLOC>::inputBase);
 
 	//assignment operators
-	BigInt_t<SIZE> & operator=(const BigInt_t<SIZE> & a);
-	BigInt_t<SIZE> & operator=(BigInt_t<SIZE> && a);
+	BigInt_t<SIZE, ALLOC> & operator=(const BigInt_t<SIZE, ALLOC> & a);
+	BigInt_t<SIZE, ALLOC> & operator=(BigInt_t<SIZE, ALLOC> && a);
 
 	//construct by vector of any integer type
 	template <class inttype>
 	BigInt_t(const std::vector<inttype> & v, char sign = 1);
 
 	//copy a to v (one to one)
-	template<int _SIZE, class inttype>
-	friend std::vector<inttype> & copy(std::vector<inttype> & v, const BigInt_t<_SIZE> & a);
+	template<int _SIZE, class _ALLOC, class inttype>
+	friend std::vector<inttype> & copy(std::vector<inttype> & v, const BigInt_t<_SIZE, _ALLOC> & a);
 
 	//destructor destructs the data vector
 	~BigInt_t();
 
 	//some unary operations and conversions to primitive types
-	BigInt_t<SIZE> operator~ () const;
+	BigInt_t<SIZE, ALLOC> operator~ () const;
 	bool operator! () const;
 
-	template<typename T>
+	//only integer types, so that classes constructed from BigInt_t (BigIntDivisor) don't take this conversion
+	template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
 	explicit operator T ();
 
 	operator bool();
@@ -245,19 +476,35 @@ public:
 
 	//static printing options
 	static unsigned inputBase;
-	static BigInt_t<SIZE> outputBase;
+	static BigInt_t<SIZE, ALLOC> outputBase;
 	static bool printPlus;
 
-	//input/output operators/functions
-	template<int _SIZE>
-	friend std::ostream & operator<<(std::ostream & s, const BigInt_t<_SIZE> & a);
-	template<int _SIZE>
-	friend std::istream & operator>>(std::istream & s, BigInt_t<_SIZE> & a);
+	//parallel multiplication options: the products of operands of at least parallelLimit limbs
+	//are shared by n worker threads after set_threads(n). By default there are no threads
+	static size_t parallelLimit;
+	static void set_threads(size_t n);
 
-	std::string to_string(BigInt_t<SIZE> base = BigInt_t<SIZE>::outputBase) const;
+	//input/output operators/functions
+	template<int _SIZE, class _ALLOC>
+	friend std::ostream & operator<<(std::ostream & s, const BigInt_t<_SIZE, _ALLOC> & a);
+	template<int _SIZE, class _ALLOC>
+	friend std::istream & operator>>(std::istream & s, BigInt_t<_SIZE, _ALLOC> & a);
+
+	std::string to_string(BigInt_t<SIZE, ALLOC> base = BigInt_t<SIZE, ALLOC>::outputBase) const;
+
+	//upper bound of the count of characters which to_chars writes in base
+	size_t chars_bound(unsigned base = 10) const;
+	//writes this BigInt_t to [first, last) like std::to_chars, with '+' if printPlus is set. Returns the end
+	//of the characters or std::errc::value_too_large, chars_bound(base) characters are enough. Numbers
+	//shorter than TO_STRING_DC_LIMIT limbs and all numbers in bases 2^k are written without heap allocation
+	BigIntUtility::to_chars_result to_chars(char * first, char * last, unsigned base = 10) const;
+	//reads value from the longest prefix of [first, last) which is a number with an optional sign.
+	//Returns the end of the prefix or std::errc::invalid_argument if it has no digits. The limbs of value
+	//are reused, so numbers shorter than FROM_STRING_DC_LIMIT limbs are read without heap allocation
+	static BigIntUtility::from_chars_result from_chars(const char * first, const char * last, BigInt_t<SIZE, ALLOC> & value, unsigned base = 10);
 
 	//generate random BigInt_t of d digits
-	static BigInt_t<SIZE> get_random(unsigned digits);
+	static BigInt_t<SIZE, ALLOC> get_random(unsigned digits);
 
 public:
 	//check if this BigInt_t is null
@@ -272,117 +519,249 @@ public:
 	inline bool isEven() const;
 
 	//inverts the sign
-	inline BigInt_t<SIZE> & negate();
+	inline BigInt_t<SIZE, ALLOC> & negate();
 	//sign of this BigInt_t
 	inline char signum() const;
 	//return the absolute value of this BigInt_t
-	BigInt_t<SIZE> abs() const;
+	BigInt_t<SIZE, ALLOC> abs() const;
 	//makes this BigInt_t positive (sets sign = 1)
-	inline BigInt_t<SIZE> & make_positive();
+	inline BigInt_t<SIZE, ALLOC> & make_positive();
 	//return the number of digits
 	inline size_t dig() const;
 
 	// x <=> y: -1 if x < y else (0 if x = y else 1)
 	// |*this| <=> |a|
-	char compareAbs(const BigInt_t<SIZE> & a, long long bigShiftA = 0) const;
+	char compareAbs(const BigInt_t<SIZE, ALLOC> & a, long long bigShiftA = 0) const;
 	// *this <=> a
-	char compare(const BigInt_t<SIZE> & a) const;
+	char compare(const BigInt_t<SIZE, ALLOC> & a) const;
 	//comparison operators
-	bool operator< (const BigInt_t<SIZE> & a) const;
-	bool operator> (const BigInt_t<SIZE> & a) const;
-	bool operator== (const BigInt_t<SIZE> & a) const;
-	bool operator!= (const BigInt_t<SIZE> & a) const;
-	bool operator<= (const BigInt_t<SIZE> & a) const;
-	bool operator>= (const BigInt_t<SIZE> & a) const;
-
-	//addition and substraction
-	BigInt_t<SIZE> operator + (const BigInt_t<SIZE> & a) const;
-	BigInt_t<SIZE> operator - (const BigInt_t<SIZE> & a) const;
-	BigInt_t<SIZE> operator - () const;
-	BigInt_t<SIZE> & operator += (const BigInt_t<SIZE> & a);
-	BigInt_t<SIZE> & operator -= (const BigInt_t<SIZE> & a);
-	BigInt_t<SIZE> & operator ++ ();
-	BigInt_t<SIZE> operator ++ (int);
-	BigInt_t<SIZE> & operator -- ();
-	BigInt_t<SIZE> operator -- (int);
+	bool operator< (const BigInt_t<SIZE, ALLOC> & a) const;
+	bool operator> (const BigInt_t<SIZE, ALLOC> & a) const;
+	bool operator== (const BigInt_t<SIZE, ALLOC> & a) const;
+	bool operator!= (const BigInt_t<SIZE, ALLOC> & a) const;
+	bool operator<= (const BigInt_t<SIZE, ALLOC> & a) const;
+	bool operator>= (const BigInt_t<SIZE, ALLOC> & a) const;
+
+	//addition and substraction. The overloads for temporaries compute the result in the limbs of the temporary
+	BigInt_t<SIZE, ALLOC> operator + (const BigInt_t<SIZE, ALLOC> & a) const &;
+	BigInt_t<SIZE, ALLOC> operator + (const BigInt_t<SIZE, ALLOC> & a) &&;
+	BigInt_t<SIZE, ALLOC> operator + (BigInt_t<SIZE, ALLOC> && a) const &;
+	BigInt_t<SIZE, ALLOC> operator + (BigInt_t<SIZE, ALLOC> && a) &&;
+	BigInt_t<SIZE, ALLOC> operator - (const BigInt_t<SIZE, ALLOC> & a) const &;
+	BigInt_t<SIZE, ALLOC> operator - (const BigInt_t<SIZE, ALLOC> & a) &&;
+	BigInt_t<SIZE, ALLOC> operator - (BigInt_t<SIZE, ALLOC> && a) const &;
+	BigInt_t<SIZE, ALLOC> operator - (BigInt_t<SIZE, ALLOC> && a) &&;
+	BigInt_t<SIZE, ALLOC> operator - () const &;
+	BigInt_t<SIZE, ALLOC> operator - () &&;
+	BigInt_t<SIZE, ALLOC> & operator += (const BigInt_t<SIZE, ALLOC> & a);
+	BigInt_t<SIZE, ALLOC> & operator -= (const BigInt_t<SIZE, ALLOC> & a);
+	BigInt_t<SIZE, ALLOC> & operator ++ ();
+	BigInt_t<SIZE, ALLOC> operator ++ (int);
+	BigInt_t<SIZE, ALLOC> & operator -- ();
+	BigInt_t<SIZE, ALLOC> operator -- (int);
 
 	//shift operators
 	// *this * 2^(SOI*n)
-	BigInt_t<SIZE> & big_shift(long long n);
+	BigInt_t<SIZE, ALLOC> & big_shift(long long n);
 	// *this / 2^n
-	BigInt_t<SIZE> operator >> (long long n) const;
-	BigInt_t<SIZE> & operator >>= (long long n);
-	BigInt_t<SIZE> operator >> (int n) const;
-	BigInt_t<SIZE> & operator >>= (int n);
+	BigInt_t<SIZE, ALLOC> operator >> (long long n) const;
+	BigInt_t<SIZE, ALLOC> & operator >>= (long long n);
+	BigInt_t<SIZE, ALLOC> operator >> (int n) const;
+	BigInt_t<SIZE, ALLOC> & operator >>= (int n);
 	// *this * 2^n
-	BigInt_t<SIZE> operator << (long long n) const;
-	BigInt_t<SIZE> & operator <<= (long long n);
-	BigInt_t<SIZE> operator << (int n) const;
-	BigInt_t<SIZE> & operator <<= (int n);
+	BigInt_t<SIZE, ALLOC> operator << (long long n) const;
+	BigInt_t<SIZE, ALLOC> & operator <<= (long long n);
+	BigInt_t<SIZE, ALLOC> operator << (int n) const;
+	BigInt_t<SIZE, ALLOC> & operator <<= (int n);
 
 	//multiplication operators
-	template<int _SIZE> friend BigInt_t<_SIZE> operator * (bui a, const BigInt_t<_SIZE> & b);
-	template<int _SIZE> friend BigInt_t<_SIZE> operator * (const BigInt_t<_SIZE> & b, bui a);
-	BigInt_t<SIZE> operator * (const BigInt_t<SIZE> & a) const;
-	BigInt_t<SIZE> & operator *= (const BigInt_t<SIZE> & a);
-	BigInt_t<SIZE> & operator *= (const bui a);
+	template<int _SIZE, class _ALLOC> friend BigInt_t<_SIZE, _ALLOC> operator * (bui a, const BigInt_t<_SIZE, _ALLOC> & b);
+	template<int _SIZE, class _ALLOC> friend BigInt_t<_SIZE, _ALLOC> operator * (const BigInt_t<_SIZE, _ALLOC> & b, bui a);
+	BigInt_t<SIZE, ALLOC> operator * (const BigInt_t<SIZE, ALLOC> & a) const;
+	BigInt_t<SIZE, ALLOC> & operator *= (const BigInt_t<SIZE, ALLOC> & a);
+	BigInt_t<SIZE, ALLOC> & operator *= (const bui a);
+	//r += a * b, r -= a * b. The product is accumulated in the limbs of r without a temporary.
+	//a * b itself is always computed at once, so r += a * b and c - a * b build the whole product first
+	template<int _SIZE, class _ALLOC> friend BigInt_t<_SIZE, _ALLOC> & addmul(BigInt_t<_SIZE, _ALLOC> & r, const BigInt_t<_SIZE, _ALLOC> & a, const BigInt_t<_SIZE, _ALLOC> & b);
+	template<int _SIZE, class _ALLOC> friend BigInt_t<_SIZE, _ALLOC> & submul(BigInt_t<_SIZE, _ALLOC> & r, const BigInt_t<_SIZE, _ALLOC> & a, const BigInt_t<_SIZE, _ALLOC> & b);
+	template<int _SIZE, class _ALLOC> friend BigInt_t<_SIZE, _ALLOC> & addmul(BigInt_t<_SIZE, _ALLOC> & r, const BigInt_t<_SIZE, _ALLOC> & a, typename BigInt_t<_SIZE, _ALLOC>::bui b);
+	template<int _SIZE, class _ALLOC> friend BigInt_t<_SIZE, _ALLOC> & submul(BigInt_t<_SIZE, _ALLOC> & r, const BigInt_t<_SIZE, _ALLOC> & a, typename BigInt_t<_SIZE, _ALLOC>::bui b);
+	//a * b, the top level of multiplication is done by the given method (Karatsuba runs on all levels below)
+	static BigInt_t<SIZE, ALLOC> multiply(const BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b, MultMethod method = MultMethod::AUTO);
+	// *this * *this
+	BigInt_t<SIZE, ALLOC> square() const;
 
 	//division and remainder operators
-	void div(const BigInt_t<SIZE> & d, BigInt_t<SIZE> & Q, BigInt_t<SIZE> & R) const;
-	static QuRem divmod(const BigInt_t<SIZE> & a, const BigInt_t<SIZE> & b);
-	BigInt_t<SIZE> operator / (const BigInt_t<SIZE> & d) const;
-	BigInt_t<SIZE> operator % (const BigInt_t<SIZE> & d) const;
-	BigInt_t<SIZE> & operator/=(const BigInt_t<SIZE> & a);
-	BigInt_t<SIZE> & operator%=(const BigInt_t<SIZE> & a);
+	void div(const BigInt_t<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & Q, BigInt_t<SIZE, ALLOC> & R) const;
+	static QuRem divmod(const BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b);
+	//a / d, where d is known to divide a. Hensel division from the lowest limbs, no remainder is computed
+	static BigInt_t<SIZE, ALLOC> divexact(const BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & d);
+	BigInt_t<SIZE, ALLOC> operator / (const BigInt_t<SIZE, ALLOC> & d) const;
+	BigInt_t<SIZE, ALLOC> operator % (const BigInt_t<SIZE, ALLOC> & d) const;
+	// *this = *this / d rounded towards zero, returns |*this| % d. Works in place without hardware division
+	bui divmod_limb(bui d);
+	//division by a divisor prepared once for many dividends
+	void div(const BigIntDivisor<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & Q, BigInt_t<SIZE, ALLOC> & R) const;
+	BigInt_t<SIZE, ALLOC> operator / (const BigIntDivisor<SIZE, ALLOC> & d) const;
+	BigInt_t<SIZE, ALLOC> operator % (const BigIntDivisor<SIZE, ALLOC> & d) const;
+
+	//base^exp mod |mod|, exp >= 0. Sliding window exponentiation, in the Montgomery form for odd mod and by BigIntDivisor for even
+	static BigInt_t<SIZE, ALLOC> powmod(const BigInt_t<SIZE, ALLOC> & base, const BigInt_t<SIZE, ALLOC> & exp, const BigInt_t<SIZE, ALLOC> & mod);
+	BigInt_t<SIZE, ALLOC> & operator/=(const BigInt_t<SIZE, ALLOC> & a);
+	BigInt_t<SIZE, ALLOC> & operator%=(const BigInt_t<SIZE, ALLOC> & a);
 
 };
 
 typedef BigInt_t<> BigInt;
 
-template<int SIZE>
-template <typename T>
-BigInt_t<SIZE> ::operator T () {
-	static_assert(sizeof(T) % sizeof(BigInt_t<SIZE>::bui) == 0 && std::is_integral<T>::value,
-		"BigInt may be converted only to integer type which size is multiplicand of sizeof(bui)");
+//Divisor prepared for repeated division: the normalized divisor and its reciprocals
+//are computed once. Short divisors use the long division with the reciprocal of
+//the highest limb, long ones (DIV_BZ_LIMIT limbs and more) Barrett reduction
+template<int SIZE, class ALLOC>
+class BigIntDivisor {
+public:
+	typedef BigInt_t<SIZE, ALLOC> BI;
+	typedef typename BI::bui bui;
+
+	explicit BigIntDivisor(const BI & d);
+
+	const BI & divisor() const {
+		return d;
+	}
+
+	//the same results as BI::div, BI::operator/ and BI::operator% give for the divisor
+	void div(const BI & a, BI & Q, BI & R) const;
+	BI div(const BI & a) const;
+	BI mod(const BI & a) const;
+	// a = |a| mod |d| in place, q is scratch for the quotient. The limbs of a and q are reused
+	void reduce(BI & a, BI & q) const;
+
+private:
+	//the divisor, its absolute value shifted left so that the highest bit is set
+	BI d, norm;
+	//reciprocal of norm for Barrett reduction, null for short divisors
+	BI x;
+	int shift;
+	//reciprocal_top of norm
+	bui v;
+};
+
+//Montgomery form a R mod m, R = B^n, of residues modulo an odd m of n limbs.
+//Products in this form are reduced by REDC without division. The limb array
+//kernels take n-limb values below m and don't allocate
+template<int SIZE, class ALLOC>
+class BigIntMontgomery {
+public:
+	typedef BigInt_t<SIZE, ALLOC> BI;
+	typedef typename BI::bui bui;
+	typedef typename BI::buip buip;
+	typedef typename BI::buicp buicp;
+
+	explicit BigIntMontgomery(const BI & m);
+
+	const BI & modulus() const {
+		return m;
+	}
+	size_t size() const {
+		return n;
+	}
+	//size of the scratch buffer of mul and sqr in limbs
+	size_t scratch_size() const;
+
+	// a R mod m and a / R mod m
+	BI to_mont(const BI & a) const;
+	BI from_mont(const BI & a) const;
+	// a b / R mod m for a and b in the Montgomery form
+	BI mul(const BI & a, const BI & b) const;
+	// a^e mod m, a is in the usual form, e >= 0. Sliding window exponentiation
+	BI pow(const BI & a, const BI & e) const;
+
+	// r = t / R mod m for t of 2n limbs, t < m R. t is destroyed
+	void redc(buip r, buip t) const;
+	// r = a b / R mod m, ws has scratch_size() limbs. r may be equal to a or b
+	void mul(buip r, buicp a, buicp b, buip ws) const;
+	void sqr(buip r, buicp a, buip ws) const;
+
+private:
+	//the modulus, R^2 mod m
+	BI m, r2;
+	size_t n;
+	// -1 / m mod B
+	bui minv;
+
+	// r[0, n) = a, 0 <= a < m
+	void load(buip r, const BI & a) const;
+	BI store(buicp a) const;
+};
+
+template<int SIZE, class ALLOC>
+template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type>
+BigInt_t<SIZE, ALLOC> ::operator T () {
+	static_assert(sizeof(T) < sizeof(BigInt_t<SIZE, ALLOC>::bui) || sizeof(T) % sizeof(BigInt_t<SIZE, ALLOC>::bui) == 0,
+		"BigInt may be converted only to integer type which size is multiplicand of sizeof(bui) or less than it");
+
+	//T narrower than bui is the lower bits of the lowest limb
+	typedef typename std::make_unsigned<T>::type U;
+	if (sizeof(T) < sizeof(bui))
+		return T(dig() ? U(data[0]) : U(0)) * sgn;
 
 	const int iters = sizeof(T) / sizeof(bui);
-	typename std::make_unsigned<T>::type res = 0;
+	//no shift when T is as wide as bui, there is one limb then
+	const unsigned sh = sizeof(T) > sizeof(bui) ? SOI : 0;
+	U res = 0;
 	for (size_t i = iters; i--> 0;) {
 		if (i < dig()) {
-			res <<= SOI;
+			res <<= sh;
 			res += data[i];
 		}
 	}
 	return T(res) * sgn;
 }
 
-template<int SIZE> unsigned BigInt_t<SIZE>::inputBase = 10;
-template<int SIZE> BigInt_t<SIZE> BigInt_t<SIZE>::outputBase = 10;
-template<int SIZE> bool BigInt_t<SIZE>::printPlus = false;
-template<int SIZE> const BigInt_t<SIZE> BigInt_t<SIZE>::C_1 = BigInt_t<SIZE>(1, { 1 });
+template<int SIZE, class ALLOC> unsigned BigInt_t<SIZE, ALLOC>::inputBase = 10;
+template<int SIZE, class ALLOC> BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::outputBase = 10;
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::printPlus = false;
+template<int SIZE, class ALLOC> size_t BigInt_t<SIZE, ALLOC>::parallelLimit = 2000;
+template<int SIZE, class ALLOC> const BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::C_1 = BigInt_t<SIZE, ALLOC>(1, { 1 });
+
+#if defined(BIGINT_TUNE)
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::KARATSUBA_LIMIT = BigIntUtility::thresholds<SIZE>::KARATSUBA_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::TOOM3_LIMIT = BigIntUtility::thresholds<SIZE>::TOOM3_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::TOOM4_LIMIT = BigIntUtility::thresholds<SIZE>::TOOM4_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::NTT_LIMIT = BigIntUtility::thresholds<SIZE>::NTT_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::SQR_KARATSUBA_LIMIT = BigIntUtility::thresholds<SIZE>::SQR_KARATSUBA_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::SQR_TOOM3_LIMIT = BigIntUtility::thresholds<SIZE>::SQR_TOOM3_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::SQR_TOOM4_LIMIT = BigIntUtility::thresholds<SIZE>::SQR_TOOM4_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::SQR_NTT_LIMIT = BigIntUtility::thresholds<SIZE>::SQR_NTT_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::DIV_BZ_LIMIT = BigIntUtility::thresholds<SIZE>::DIV_BZ_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::DIV_NEWTON_LIMIT = BigIntUtility::thresholds<SIZE>::DIV_NEWTON_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::DIVEXACT_LIMIT = BigIntUtility::thresholds<SIZE>::DIVEXACT_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::TO_STRING_DC_LIMIT = BigIntUtility::thresholds<SIZE>::TO_STRING_DC_LIMIT;
+template<int SIZE, class ALLOC> unsigned int BigInt_t<SIZE, ALLOC>::FROM_STRING_DC_LIMIT = BigIntUtility::thresholds<SIZE>::FROM_STRING_DC_LIMIT;
+#endif
 
-template<int SIZE>
+template<int SIZE, class ALLOC>
 template<typename signed_int>
-char BigInt_t<SIZE>::sign(signed_int val) {
+char BigInt_t<SIZE, ALLOC>::sign(signed_int val) {
 	static_assert(std::is_signed<signed_int>::value, "signed_int shoud be signed integral");
 
 	return (val > 0) ? 1 : ((val == 0) ? 0 : -1);
 }
 
-template<int SIZE>
+template<int SIZE, class ALLOC>
 template<typename signed_int>
-signed_int BigInt_t<SIZE>::abs_num(signed_int val) {
+signed_int BigInt_t<SIZE, ALLOC>::abs_num(signed_int val) {
 	static_assert(std::is_signed<signed_int>::value, "signed_int shoud be signed integral");
 
 	return (val > 0) ? val : -val;
 }
 
-template<int SIZE>
+template<int SIZE, class ALLOC>
 template<typename unsigned_int>
-unsigned_int BigInt_t<SIZE>::pow_num(unsigned_int val, char n) {
+unsigned_int BigInt_t<SIZE, ALLOC>::pow_num(unsigned_int val, char n) {
 	static_assert(std::is_unsigned<unsigned_int>::value, "unsigned_int shoud be unsigned integral");
 
-	auto res = 1;
+	unsigned_int res = 1;
 	while (n > 0) {
 		res *= val;
 		--n;
@@ -390,8 +769,8 @@ unsigned_int BigInt_t<SIZE>::pow_num(unsigned_int val, char n) {
 	return res;
 }
 
-template<int SIZE>
-typename BigInt_t<SIZE>::bui BigInt_t<SIZE>::last_possible_power(bui n, unsigned & last_p) {
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::last_possible_power(bui n, unsigned & last_p) {
 	last_p = 0;
 	lui last_pow = 1;
 	while (1) {
@@ -404,8 +783,8 @@ typename BigInt_t<SIZE>::bui BigInt_t<SIZE>::last_possible_power(bui n, unsigned
 	}
 }
 
-template<int SIZE>
-unsigned char BigInt_t<SIZE>::digval(char digit) {
+template<int SIZE, class ALLOC>
+unsigned char BigInt_t<SIZE, ALLOC>::digval(char digit) {
 	if (digit >= '0' && digit <= '9') {
 		return digit - '0';
 	}
@@ -418,8 +797,8 @@ unsigned char BigInt_t<SIZE>::digval(char digit) {
 	throw BigIntIllegalDigitException();
 }
 
-template<int SIZE>
-char BigInt_t<SIZE>::dig_by_val(bui val) {
+template<int SIZE, class ALLOC>
+char BigInt_t<SIZE, ALLOC>::dig_by_val(bui val) {
 	if (val >= 0 && val <= 9) {
 		return '0' + val;
 	}
@@ -429,9 +808,9 @@ char BigInt_t<SIZE>::dig_by_val(bui val) {
 	throw BigIntIllegalDigitException();
 }
 
-template<int SIZE>
+template<int SIZE, class ALLOC>
 template<typename int_type>
-std::pair<int_type, int_type> BigInt_t<SIZE>::quo_rem(int_type a, int_type b) {
+std::pair<int_type, int_type> BigInt_t<SIZE, ALLOC>::quo_rem(int_type a, int_type b) {
 	static_assert(std::is_integral<int_type>::value, "int_type shoud be integral");
 
 	int_type q = a / b;
@@ -442,8 +821,8 @@ std::pair<int_type, int_type> BigInt_t<SIZE>::quo_rem(int_type a, int_type b) {
 		return std::make_pair(q - 1, r + b);
 }
 
-template<int _SIZE, class inttype>
-std::vector<inttype> & copy(std::vector<inttype> & v, const BigInt_t<_SIZE> & a) {
+template<int _SIZE, class _ALLOC, class inttype>
+std::vector<inttype> & copy(std::vector<inttype> & v, const BigInt_t<_SIZE, _ALLOC> & a) {
 	static_assert(std::is_integral<inttype>::value, "int_type shoud be integral");
 
 	v.resize(a.dig());
@@ -453,16 +832,13 @@ std::vector<inttype> & copy(std::vector<inttype> & v, const BigInt_t<_SIZE> & a)
 	return v;
 }
 
-template<int SIZE>
-BigInt_t<SIZE>::BigInt_t(const std::string & val, unsigned inB) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC>::BigInt_t(const std::string & val, unsigned inB) {
 	if (val.empty()) {
 		sgn = 0;
 		return;
 	}
 
-	unsigned MAX_CHAR_READ;
-	auto last_pow = last_possible_power(inB, MAX_CHAR_READ);
-
 	char res_sgn = 1;
 	auto p = val.data();
 	auto pEnd = p + val.size();
@@ -475,40 +851,179 @@ BigInt_t<SIZE>::BigInt_t(const std::string & val, unsigned inB) {
 		++p;
 	}
 
-	data.reserve((size_t)((val.size() + 1) / log10l((long double)C_MAX_DIG_1)) + 1);
-	unsigned char_read = 0, r = 0;
-	for (; p != pEnd; ++p) {
-		r *= inB;
-		r += digval(*p);
-		++char_read;
-		if (char_read == MAX_CHAR_READ) {
-			*this *= (unsigned)last_pow;
-			addAbs(*this, r);
-			r = char_read = 0;
+	assign_digits(p, pEnd - p, inB);
+	if (sgn)
+		sgn = res_sgn;
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::assign_digits(const char * s, size_t len, unsigned base) {
+	unsigned c;
+	bui power = last_possible_power(base, c);
+	if (unsigned k = pow2_base(base))
+		read_digits_pow2(*this, s, len, k);
+	else if (len < (size_t)c * FROM_STRING_DC_LIMIT)
+		read_digits_basecase(*this, s, len, base, c, power);
+	else {
+		//the powers of the base are cached with the default allocator
+		std::vector<BigInt_t<SIZE>> top;
+		*this = BigInt_t<SIZE, ALLOC>(BigInt_t<SIZE>::read_digits(s, len, base, c, BigInt_t<SIZE>::radix_powers(base, len / c + 1, top)));
+	}
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::read_digits(const char * s, size_t len, bui base, unsigned c, const std::vector<BigInt_t<SIZE, ALLOC>> & pw) {
+	if (len < (size_t)c * FROM_STRING_DC_LIMIT || len < 2 * (size_t)c) {
+		BigInt_t<SIZE, ALLOC> res;
+		read_digits_basecase(res, s, len, base, c, pw[0][0]);
+		return res;
+	}
+
+	//the lower part has c 2^i digits, from a quarter to a half of them
+	size_t i = pw.size() - 1;
+	while (2 * ((size_t)c << i) > len)
+		--i;
+	size_t low = (size_t)c << i;
+
+	BigInt_t<SIZE, ALLOC> res = read_digits(s, len - low, base, c, pw) * pw[i];
+	return addAbs(res, read_digits(s + len - low, low, base, c, pw));
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::read_digits_basecase(BigInt_t<SIZE, ALLOC> & res, const char * s, size_t len, bui base, unsigned c, bui power) {
+	res.data.resize(len / c + 1);
+	buip r = res.get_ptr();
+	size_t n = 0;
+
+	//the highest chunk may be shorter, the next ones have c digits
+	for (size_t k = (len - 1) % c + 1; len; len -= k, k = c) {
+		bui chunk = 0, mul = 1;
+		for (size_t j = 0; j < k; ++j, ++s) {
+			chunk = bui(chunk * base + digval(*s));
+			mul = bui(mul * base);
+		}
+		bui carry = mul_1(r, r, n, k == c ? power : mul, chunk);
+		if (carry)
+			r[n++] = carry;
+	}
+
+	res.data.resize(n);
+	res.sgn = n ? 1 : 0;
+}
+
+template<int SIZE, class ALLOC>
+unsigned BigInt_t<SIZE, ALLOC>::pow2_base(bui base) {
+	if (base < 2 || (base & (base - 1)))
+		return 0;
+	return BigIntUtility::_log2(base);
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::write_digits_pow2(char * s, size_t len, const BigInt_t<SIZE, ALLOC> & a, unsigned k) {
+	static const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+	//digits of all bytes for k = 1, 2, 4, the lowest digit is the last one
+	static const auto byte_digits = []() {
+		std::array<std::array<std::array<char, 8>, 256>, 3> t;
+		for (unsigned l = 0; l < 3; ++l)
+			for (unsigned b = 0; b < 256; ++b)
+				for (unsigned q = 0; q < (8u >> l); ++q)
+					t[l][b][7 - q] = digits[(b >> (q << l)) & ((1u << (1u << l)) - 1)];
+		return t;
+	}();
+	const bui mask = bui((1u << k) - 1);
+	buicp p = a.get_ptr();
+	size_t n = a.dig();
+	char * e = s + len;
+	size_t pos = 0;
+
+	//whole bytes by the table if k divides 8
+	if (8 % k == 0) {
+		unsigned d = 8 / k;
+		auto & t = byte_digits[BigIntUtility::_log2(k)];
+		for (; (size_t)(e - s) >= d; pos += 8) {
+			e -= d;
+			memcpy(e, t[(unsigned char)(p[pos / SOI] >> (pos % SOI))].data() + 8 - d, d);
 		}
 	}
-	if (char_read != 0) {
-		*this *= pow_num(inB, char_read);
-		addAbs(*this, r);
+	//the digit i is the slice of k bits from the bit i k, it may cross two limbs
+	for (; e != s; pos += k) {
+		size_t w = pos / SOI;
+		unsigned off = pos % SOI;
+		bui v = bui(p[w] >> off);
+		if (off + k > SOI && w + 1 < n)
+			v |= bui(p[w + 1] << (SOI - off));
+		*--e = digits[v & mask];
 	}
+}
 
-	sgn = res_sgn;
-	normalize();
+template<int SIZE, class ALLOC>
+const std::array<unsigned char, 256> & BigInt_t<SIZE, ALLOC>::digit_values() {
+	static const auto values = []() {
+		std::array<unsigned char, 256> t;
+		t.fill(0xFF);
+		for (int ch = 0; ch < 256; ++ch)
+			if ((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z'))
+				t[ch] = digval(char(ch));
+		return t;
+	}();
+	return values;
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::read_digits_pow2(BigInt_t<SIZE, ALLOC> & res, const char * s, size_t len, unsigned k) {
+	auto & values = digit_values();
+	const unsigned base = 1u << k;
+	res.data.assign((len * k + SOI - 1) / SOI, 0);
+	buip r = res.get_ptr();
+
+	const char * e = s + len;
+	size_t pos = 0;
+
+	//whole limbs in a register if k divides SOI. The digits are less than base
+	//if their bitwise or is less than it
+	if (SOI % k == 0) {
+		for (; (size_t)(e - s) >= SOI / k; pos += SOI) {
+			bui limb = 0;
+			unsigned char any = 0;
+			for (unsigned j = 0; j < SOI; j += k) {
+				unsigned char v = values[(unsigned char)*--e];
+				any |= v;
+				limb |= bui(bui(v) << j);
+			}
+			if (any >= base)
+				throw BigIntIllegalDigitException();
+			r[pos / SOI] = limb;
+		}
+	}
+	//the digit i from the end fills the bits from i k, which may cross two limbs
+	for (; e != s; pos += k) {
+		unsigned char v = values[(unsigned char)*--e];
+		if (v >= base)
+			throw BigIntIllegalDigitException();
+		size_t w = pos / SOI;
+		unsigned off = pos % SOI;
+		r[w] |= bui(bui(v) << off);
+		if (off + k > SOI)
+			r[w + 1] |= bui(v >> (SOI - off));
+	}
+
+	res.sgn = 1;
+	res.normalize();
 }
 
-template<int SIZE>
-BigInt_t<SIZE>::BigInt_t(unsigned long long val, char sign) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC>::BigInt_t(unsigned long long val, char sign) {
 	sgn = val == 0 ? 0 : sign;
 
 	while (val > 0) {
 		data.push_back((bui)(val & C_MAX_DIG));
-		val >>= SOI;
+		val = SOI < 64 ? val >> (SOI % 64) : 0;
 	}
 }
 
-template<int SIZE>
+template<int SIZE, class ALLOC>
 template<class inttype>
-BigInt_t<SIZE>::BigInt_t(const std::vector<inttype>& v, char sign) {
+BigInt_t<SIZE, ALLOC>::BigInt_t(const std::vector<inttype>& v, char sign) {
 	data.resize(v.size());
 	auto itv = v.cbegin();
 	for (auto it = data.begin(); it != data.end(); ++it, ++itv) {
@@ -518,8 +1033,8 @@ BigInt_t<SIZE>::BigInt_t(const std::vector<inttype>& v, char sign) {
 	normalize();
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator=(const BigInt_t<SIZE> & a) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator=(const BigInt_t<SIZE, ALLOC> & a) {
 	if (this != &a) {
 		sgn = a.sgn;
 		data = a.data;
@@ -527,8 +1042,8 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::operator=(const BigInt_t<SIZE> & a) {
 	return *this;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator=(BigInt_t<SIZE> && a) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator=(BigInt_t<SIZE, ALLOC> && a) {
 	if (this != &a) {
 		sgn = a.sgn;
 		data = std::move(a.data);
@@ -536,88 +1051,232 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::operator=(BigInt_t<SIZE> && a) {
 	return *this;
 }
 
-template<int SIZE> BigInt_t<SIZE>::~BigInt_t() {
+template<int SIZE, class ALLOC> BigInt_t<SIZE, ALLOC>::~BigInt_t() {
 	data.clear();
 }
 
-template<int SIZE> BigInt_t<SIZE> BigInt_t<SIZE>::operator~() const {
+template<int SIZE, class ALLOC> BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator~() const {
 	return -C_1 - *this;
 }
 
-template<int SIZE> bool BigInt_t<SIZE>::operator!() const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::operator!() const {
 	return isNull();
 }
 
-template<int SIZE> BigInt_t<SIZE>::operator bool() {
+template<int SIZE, class ALLOC> BigInt_t<SIZE, ALLOC>::operator bool() {
 	return !isNull();
 }
 
-template<int SIZE> BigInt_t<SIZE>::operator std::string() {
+template<int SIZE, class ALLOC> BigInt_t<SIZE, ALLOC>::operator std::string() {
 	return to_string();
 }
 
-template<int _SIZE> std::ostream & operator <<(std::ostream & s, const BigInt_t<_SIZE> & a) {
-	return s << a.to_string();
+template<int _SIZE, class _ALLOC> std::ostream & operator <<(std::ostream & s, const BigInt_t<_SIZE, _ALLOC> & a) {
+	//the field width is applied by the output of std::string
+	unsigned base = (unsigned)BigInt_t<_SIZE, _ALLOC>::outputBase[0];
+	char buf[256];
+	if (s.width() != 0 || a.chars_bound(base) > sizeof(buf))
+		return s << a.to_string();
+	auto res = a.to_chars(buf, buf + sizeof(buf), base);
+	return s.write(buf, res.ptr - buf);
 }
 
-template<int _SIZE> std::istream & operator>>(std::istream & s, BigInt_t<_SIZE>& a) {
-	std::string str;
+template<int _SIZE, class _ALLOC> std::istream & operator>>(std::istream & s, BigInt_t<_SIZE, _ALLOC>& a) {
+	//the buffer keeps its capacity between calls
+	thread_local std::string str;
+	str.clear();
 	s >> str;
-	a = BigInt_t<_SIZE>(str);
+	auto res = BigInt_t<_SIZE, _ALLOC>::from_chars(str.data(), str.data() + str.size(), a, BigInt_t<_SIZE, _ALLOC>::inputBase);
+	if (str.empty())
+		a = 0;
+	else if (res.ptr != str.data() + str.size())
+		throw BigIntIllegalDigitException();
+	return s;
+}
+
+template<int SIZE, class ALLOC> std::string BigInt_t<SIZE, ALLOC>::to_string(BigInt_t<SIZE, ALLOC> base) const {
+	unsigned base_int = (unsigned)base[0];
+	std::string s(chars_bound(base_int), '0');
+	auto res = to_chars(&s[0], &s[0] + s.size(), base_int);
+	if (res.ec != std::errc())
+		throw BigIntIllegalDigitException();
+	s.resize(res.ptr - &s[0]);
 	return s;
 }
 
-template<int SIZE> std::string BigInt_t<SIZE>::to_string(BigInt_t<SIZE> base) const {
-	std::vector<std::string> out;
-	std::ostringstream s;
-	if (isNeg() || BigInt_t<SIZE>::printPlus)
-		s << (isNeg() ? '-' : '+');
+template<int SIZE, class ALLOC>
+size_t BigInt_t<SIZE, ALLOC>::bit_length() const {
+	return isNull() ? 0 : (dig() - 1) * SOI + BigIntUtility::_log2(data.back()) + 1;
+}
+
+template<int SIZE, class ALLOC>
+size_t BigInt_t<SIZE, ALLOC>::chars_bound(unsigned base) const {
+	if (unsigned k = pow2_base(base))
+		return (bit_length() + k - 1) / k + 2;
+	return (size_t)(bit_length() * log10l(2.0L) / log10l((long double)base)) + 3;
+}
+
+template<int SIZE, class ALLOC>
+BigIntUtility::to_chars_result BigInt_t<SIZE, ALLOC>::to_chars(char * first, char * last, unsigned base) const {
+	if (base < 2 || base > 36)
+		return { last, std::errc::invalid_argument };
+	if (isNeg() || BigInt_t<SIZE, ALLOC>::printPlus) {
+		if (first == last)
+			return { last, std::errc::value_too_large };
+		*first++ = isNeg() ? '-' : '+';
+	}
 	if (isNull()) {
-		out.push_back("0");
+		if (first == last)
+			return { last, std::errc::value_too_large };
+		*first++ = '0';
+		return { first, std::errc() };
+	}
+
+	if (unsigned k = pow2_base(base)) {
+		size_t len = (bit_length() + k - 1) / k;
+		if ((size_t)(last - first) < len)
+			return { last, std::errc::value_too_large };
+		write_digits_pow2(first, len, *this, k);
+		return { first + len, std::errc() };
 	}
-	else {
-		BigInt_t<SIZE> A = abs(), R, Q;
-
-		unsigned char_written;
-		bui base_int = base[0];
-		BigInt_t<SIZE> PowerB = last_possible_power(base_int, char_written);
-		std::string str(char_written, '0');
-
-		while (A.isPos()) {
-			A.div(PowerB, Q, R);
-			A = Q;
-			bui r0 = bui(R);
-
-			if (A.isNull()) {
-				str = "";
-				while (r0) {
-					str = BigInt_t<SIZE>::dig_by_val(r0 % base_int) + str;
-					r0 /= base_int;
-				}
-			}
-			else {
-				std::fill(str.begin(), str.end(), '0');
-				int i = char_written;
-				while (r0) {
-					str[--i] = BigInt_t<SIZE>::dig_by_val(r0 % base_int);
-					r0 /= base_int;
-				}
-			}
 
-			out.push_back(str);
+	//the digits are written to the end of at most chars_bound characters, then leading zeros are removed
+	size_t len = std::min((size_t)(last - first), chars_bound(base) - 1);
+	unsigned c;
+	bui power = last_possible_power(base, c);
+	bool fits;
+	if (dig() < TO_STRING_DC_LIMIT) {
+		//the limbs are divided in a buffer which keeps its capacity between calls
+		thread_local intvec limbs;
+		limbs.assign(data.begin(), data.end());
+		fits = write_digits_basecase(first, len, limbs.data(), limbs.size(), base, c, power);
+	}
+	else {
+		//the powers of the base are cached with the default allocator
+		BigInt_t<SIZE> A(abs());
+		std::vector<BigIntDivisor<SIZE>> top;
+		fits = BigInt_t<SIZE>::write_digits(first, len, A, base, c, BigInt_t<SIZE>::radix_divisors(base, A.dig(), top));
+	}
+	if (!fits)
+		return { last, std::errc::value_too_large };
+
+	size_t z = std::find_if(first, first + len, [](char ch) { return ch != '0'; }) - first;
+	memmove(first, first + z, len - z);
+	return { first + len - z, std::errc() };
+}
+
+template<int SIZE, class ALLOC>
+BigIntUtility::from_chars_result BigInt_t<SIZE, ALLOC>::from_chars(const char * first, const char * last, BigInt_t<SIZE, ALLOC> & value, unsigned base) {
+	if (base < 2 || base > 36)
+		return { first, std::errc::invalid_argument };
+	const char * p = first;
+	char s = 1;
+	if (p != last && (*p == '-' || *p == '+')) {
+		s = *p == '-' ? -1 : 1;
+		++p;
+	}
+	auto & values = digit_values();
+	const char * e = p;
+	while (e != last && values[(unsigned char)*e] < base)
+		++e;
+	if (e == p)
+		return { first, std::errc::invalid_argument };
+
+	value.assign_digits(p, e - p, base);
+	if (value.sgn)
+		value.sgn = s;
+	return { e, std::errc() };
+}
+
+template<int SIZE, class ALLOC>
+const std::vector<BigInt_t<SIZE, ALLOC>> & BigInt_t<SIZE, ALLOC>::radix_powers(bui base, size_t n, std::vector<BigInt_t<SIZE, ALLOC>> & top) {
+	thread_local std::map<bui, std::vector<BigInt_t<SIZE, ALLOC>>> cache;
+	auto & pw = cache[base];
+	if (pw.empty()) {
+		unsigned c;
+		pw.emplace_back(last_possible_power(base, c), 1);
+	}
+	while (2 * pw.back().dig() <= n + 1) {
+		auto p = pw.back().square();
+		if (p.dig() > RADIX_CACHE_LIMIT) {
+			top = pw;
+			top.push_back(std::move(p));
+			while (2 * top.back().dig() <= n + 1)
+				top.push_back(top.back().square());
+			return top;
 		}
+		pw.push_back(std::move(p));
+	}
+	return pw;
+}
+
+template<int SIZE, class ALLOC>
+const std::vector<BigIntDivisor<SIZE, ALLOC>> & BigInt_t<SIZE, ALLOC>::radix_divisors(bui base, size_t n, std::vector<BigIntDivisor<SIZE, ALLOC>> & top) {
+	thread_local std::map<bui, std::vector<BigIntDivisor<SIZE, ALLOC>>> cache;
+	auto & dv = cache[base];
+	std::vector<BigInt_t<SIZE, ALLOC>> top_powers;
+	auto & pw = radix_powers(base, n, top_powers);
+	while (dv.size() < pw.size() && pw[dv.size()].dig() <= RADIX_CACHE_LIMIT)
+		dv.emplace_back(pw[dv.size()]);
+	if (dv.size() == pw.size())
+		return dv;
+
+	top = dv;
+	while (top.size() < pw.size())
+		top.emplace_back(pw[top.size()]);
+	return top;
+}
+
+template<int SIZE, class ALLOC>
+bool BigInt_t<SIZE, ALLOC>::write_digits(char * s, size_t len, BigInt_t<SIZE, ALLOC> & a, bui base, unsigned c, const std::vector<BigIntDivisor<SIZE, ALLOC>> & pw) {
+	size_t n = a.dig();
+	if (n < TO_STRING_DC_LIMIT || n < 2) {
+		bool fits = write_digits_basecase(s, len, a.get_ptr(), n, base, c, pw[0].divisor()[0]);
+		a = BigInt_t<SIZE, ALLOC>();
+		return fits;
 	}
-	for (auto it = out.rbegin(); it != out.rend(); ++it) {
-		s << *it;
+
+	//the largest power of at most (n + 1) / 2 limbs, it is less than a
+	size_t i = pw.size() - 1;
+	while (2 * pw[i].divisor().dig() > n + 1)
+		--i;
+	size_t low = (size_t)c << i;
+	if (len <= low)
+		return false;
+
+	BigInt_t<SIZE, ALLOC> q, r;
+	pw[i].div(a, q, r);
+	a = BigInt_t<SIZE, ALLOC>();
+	return write_digits(s + len - low, low, r, base, c, pw) && write_digits(s, len - low, q, base, c, pw);
+}
+
+template<int SIZE, class ALLOC>
+bool BigInt_t<SIZE, ALLOC>::write_digits_basecase(char * s, size_t len, buip p, size_t n, bui base, unsigned c, bui power) {
+	int sh = SOI - 1 - BigIntUtility::_log2(power);
+	bui dn = bui(power << sh), v = reciprocal_1(dn);
+	char * e = s + len;
+
+	//chunks of c digits from the lowest one, the highest chunk is cut by the buffer
+	while (n) {
+		bui r = div_1_preinv(p, p, n, dn, v, sh);
+		if (!p[n - 1])
+			--n;
+		for (unsigned j = 0; j < c && e != s; ++j) {
+			*--e = dig_by_val(r % base);
+			r /= base;
+		}
+		if (e == s && (r || n))
+			return false;
 	}
-	return s.str();
+	std::fill(s, e, '0');
+	return true;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::get_random(unsigned digits) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::get_random(unsigned digits) {
 	static std::mt19937_64 gen((unsigned)std::chrono::system_clock::now().time_since_epoch().count());
 
-	BigInt_t<SIZE> res;
+	BigInt_t<SIZE, ALLOC> res;
 	if (digits) {
 		res.data.resize(digits);
 		size_t k = res.data.size();
@@ -632,45 +1291,45 @@ BigInt_t<SIZE> BigInt_t<SIZE>::get_random(unsigned digits) {
 	return res;
 }
 
-template<int SIZE> bool BigInt_t<SIZE>::isNull() const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::isNull() const {
 	return sgn == 0;
 }
-template<int SIZE> bool BigInt_t<SIZE>::isNeg() const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::isNeg() const {
 	return sgn == -1;
 }
-template<int SIZE> bool BigInt_t<SIZE>::isPos() const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::isPos() const {
 	return sgn == 1;
 }
-template<int SIZE> bool BigInt_t<SIZE>::isOdd() const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::isOdd() const {
 	return !isNull() && ((data[0] & 1) != 0);
 }
-template<int SIZE> bool BigInt_t<SIZE>::isEven() const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::isEven() const {
 	return isNull() || ((data[0] & 1) == 0);
 }
 
-template<int SIZE> char BigInt_t<SIZE>::signum() const {
+template<int SIZE, class ALLOC> char BigInt_t<SIZE, ALLOC>::signum() const {
 	return sgn;
 }
-template<int SIZE> BigInt_t<SIZE> BigInt_t<SIZE>::abs() const {
+template<int SIZE, class ALLOC> BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::abs() const {
 	if (isNeg()) return -*this;
 	else return *this;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::make_positive()
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::make_positive()
 {
 	if (*this) {
 		sgn = 1;
 	}
 	return *this;
 }
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::negate() {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::negate() {
 	sgn = -sgn;
 	return *this;
 }
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::normalize() {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::normalize() {
 	int i = (int)data.size() - 1;
 	for (; i >= 0; --i) {
 		if (data[i] != 0)
@@ -681,22 +1340,22 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::normalize() {
 	if (data.size() == 0) sgn = 0;
 	return *this;
 }
-template<int SIZE>
-typename BigInt_t<SIZE>::buip BigInt_t<SIZE>::get_ptr() {
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::buip BigInt_t<SIZE, ALLOC>::get_ptr() {
 	return data.data();
 }
-template<int SIZE>
-typename BigInt_t<SIZE>::buicp BigInt_t<SIZE>::get_ptr() const
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::buicp BigInt_t<SIZE, ALLOC>::get_ptr() const
 {
 	return data.data();
 }
-template<int SIZE>
-size_t BigInt_t<SIZE>::dig() const {
+template<int SIZE, class ALLOC>
+size_t BigInt_t<SIZE, ALLOC>::dig() const {
 	return data.size();
 }
 
-template<int SIZE>
-char BigInt_t<SIZE>::compareAbs(const BigInt_t<SIZE> & a, long long bigShiftA) const {
+template<int SIZE, class ALLOC>
+char BigInt_t<SIZE, ALLOC>::compareAbs(const BigInt_t<SIZE, ALLOC> & a, long long bigShiftA) const {
 	if (data.size() != a.data.size() + bigShiftA) {
 		return data.size() < (a.data.size() + bigShiftA) ? -1 : 1;
 	}
@@ -713,43 +1372,43 @@ char BigInt_t<SIZE>::compareAbs(const BigInt_t<SIZE> & a, long long bigShiftA) c
 	return 0;
 }
 
-template<int SIZE>
-char BigInt_t<SIZE>::compare(const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC>
+char BigInt_t<SIZE, ALLOC>::compare(const BigInt_t<SIZE, ALLOC> & a) const {
 	if (sgn != a.sgn)
 		return sgn < a.sgn ? -1 : 1;
 	return ((sgn + a.sgn) >> 1) * compareAbs(a);
 }
-template<int SIZE> bool BigInt_t<SIZE>::operator< (const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::operator< (const BigInt_t<SIZE, ALLOC> & a) const {
 	return compare(a) == -1;
 }
-template<int SIZE> bool BigInt_t<SIZE>::operator> (const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::operator> (const BigInt_t<SIZE, ALLOC> & a) const {
 	return compare(a) == 1;
 }
-template<int SIZE> bool BigInt_t<SIZE>::operator== (const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::operator== (const BigInt_t<SIZE, ALLOC> & a) const {
 	return compare(a) == 0;
 }
-template<int SIZE> bool BigInt_t<SIZE>::operator!= (const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::operator!= (const BigInt_t<SIZE, ALLOC> & a) const {
 	return compare(a) != 0;
 }
-template<int SIZE> bool BigInt_t<SIZE>::operator<= (const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::operator<= (const BigInt_t<SIZE, ALLOC> & a) const {
 	return compare(a) <= 0;
 }
-template<int SIZE> bool BigInt_t<SIZE>::operator>= (const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC> bool BigInt_t<SIZE, ALLOC>::operator>= (const BigInt_t<SIZE, ALLOC> & a) const {
 	return compare(a) >= 0;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::addAbs(BigInt_t<SIZE> & a, const BigInt_t<SIZE> & b, long long bigShiftB) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::addAbs(BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b, long long bigShiftB) {
 	return add_abs_ptr(a, b.data.data(), b.data.data() + b.data.size(), bigShiftB);
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::subAbs(BigInt_t<SIZE> & a, const BigInt_t<SIZE> & b, long long bigShiftB) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::subAbs(BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b, long long bigShiftB) {
 	return sub_abs_ptr(a, b.data.data(), b.data.data() + b.data.size(), bigShiftB);
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::addSign(BigInt_t<SIZE> & a, const BigInt_t<SIZE> & b, char sign) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::addSign(BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b, char sign) {
 	if (a.sgn * b.sgn * sign >= 0) {
 		char sgn;
 		if (a.sgn + sign*b.sgn == 0)
@@ -767,59 +1426,79 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::addSign(BigInt_t<SIZE> & a, const BigInt_t<SIZE
 	return subAbs(a, b).negate();
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::mult(buicp a, buicp ae, buicp b, buicp be, char res_sign) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::mult(buicp a, buicp ae, buicp b, buicp be, char res_sign) {
 	size_t k = size_t(ae - a), l = size_t(be - b);
 	if (!k || !l)
-		return BigInt_t<SIZE>();
+		return BigInt_t<SIZE, ALLOC>();
 
-	BigInt_t<SIZE> res;
-	auto ke = k + (k & 1), le = l + (l & 1);
+	BigInt_t<SIZE, ALLOC> res;
+	auto n = std::min(k, l);
 
-	if (std::min(k, l) < KARATSUBA_LIMIT) {
-		lui tmp;
-		bui carry;
-		res.data.resize(k + l, 0);
-		for (size_t i = 0; i < k; ++i) {
-			carry = 0;
-			for (size_t j = 0; j < l; ++j) {
-				tmp = (lui)a[i] * b[j] + (lui)res[i + j] + carry;
-				carry = (bui)(tmp >> SOI);
-				res[i + j] = tmp & C_MAX_DIG;
-			}
-			res[i + l] = carry;
-		}
+	if (a == b && ae == be) {
+		res = sqr(a, ae);
+	}
+	else if (n < KARATSUBA_LIMIT) {
+		res = mult_school(a, ae, b, be);
+	}
+	else if (n >= NTT_LIMIT && BigIntUtility::ntt_fits<bui>(k, l)) {
+		res = mult_ntt(a, ae, b, be);
+	}
+	else if (n < TOOM3_LIMIT) {
+		res = mult_karatsuba(a, ae, b, be);
 	}
 	else {
-		res.data.reserve(k + l);
-		if (ke >= 2 * le) {
-			for (size_t i = 0; i < k; i += l) {
-				addAbs(res, mult(b, be, a + i, a + i + std::min(l, k - i), 1), i);
-			}
+		if (k < l) {
+			std::swap(a, b);
+			std::swap(ae, be);
+			std::swap(k, l);
 		}
-		else if (le >= 2 * ke) {
-			for (size_t i = 0; i < l; i += k) {
-				addAbs(res, mult(a, ae, b + i, b + i + std::min(k, l - i), 1), i);
+
+		if (2 * k >= 5 * l) {
+			//the long operand is cut into pieces of l limbs, their products are accumulated in res
+			bool par = parallel(n);
+			size_t cnt = (k + l - 1) / l;
+			res.data.resize(k + l);
+			buip r = res.get_ptr();
+			intvec tmp(par ? (cnt - 1) * 2 * l : 2 * l);
+			auto product = [=](buip dst, size_t i) {
+				mult_to(dst, b, be, a + i, a + i + std::min(l, k - i));
+			};
+			auto accumulate = [=](size_t i, buicp src) {
+				add_n(r + i, r + i, src, std::min(l, k - i) + l);
+			};
+
+			if (par) {
+				std::vector<std::function<void()>> tasks;
+				for (size_t j = 0; j < cnt; ++j) {
+					tasks.push_back([&, j]() { product(j ? tmp.data() + (j - 1) * 2 * l : r, j * l); });
+				}
+				BigIntUtility::thread_pool().run(tasks);
+				std::fill(r + 2 * l, r + k + l, bui(0));
+				for (size_t j = 1; j < cnt; ++j) {
+					accumulate(j * l, tmp.data() + (j - 1) * 2 * l);
+				}
+			}
+			else {
+				product(r, 0);
+				std::fill(r + 2 * l, r + k + l, bui(0));
+				for (size_t i = l; i < k; i += l) {
+					product(tmp.data(), i);
+					accumulate(i, tmp.data());
+				}
 			}
 		}
+		else if (4 * k >= 7 * l) {
+			res = mult_toom42(a, ae, b, be);
+		}
+		else if (10 * k >= 13 * l) {
+			res = mult_toom32(a, ae, b, be);
+		}
+		else if (n >= TOOM4_LIMIT) {
+			res = mult_toom4(a, ae, b, be);
+		}
 		else {
-			auto m = std::max(ke, le);
-			auto m2 = m >> 1;
-
-			BigInt_t<SIZE> A0, B0;
-			A0.data.resize(m2);
-			B0.data.resize(m2);
-			memcpy(A0.data.data(), a, m2 * sizeof(bui));
-			memcpy(B0.data.data(), b, m2 * sizeof(bui));
-			A0.sgn = B0.sgn = 1;
-
-			res = mult(a, a + m2, b, b + m2, 1);
-			BigInt_t<SIZE> mid = add_abs_ptr(A0, a + m2, ae) * add_abs_ptr(B0, b + m2, be);
-			BigInt_t<SIZE> A1B1 = mult(a + m2, ae, b + m2, be, 1);
-			subAbs(subAbs(mid, res), A1B1);
-
-			addAbs(res, mid, m2);
-			addAbs(res, A1B1, m);
+			res = mult_toom3(a, ae, b, be);
 		}
 	}
 
@@ -827,8 +1506,752 @@ BigInt_t<SIZE> BigInt_t<SIZE>::mult(buicp a, buicp ae, buicp b, buicp be, char r
 	return res;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::add_abs_ptr(BigInt_t<SIZE> & a, buicp b, buicp be, long long bigShiftB)
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::mult_school(buicp a, buicp ae, buicp b, buicp be) {
+	size_t k = size_t(ae - a), l = size_t(be - b);
+	BigInt_t<SIZE, ALLOC> res;
+	res.data.resize(k + l);
+	mul_basecase(res.get_ptr(), a, k, b, l);
+	res.sgn = 1;
+	return res;
+}
+
+//the whole recursion runs in one scratch buffer and writes into the limbs of the result
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::mult_karatsuba(buicp a, buicp ae, buicp b, buicp be) {
+	size_t k = size_t(ae - a), l = size_t(be - b);
+	bool par = parallel(std::min(k, l));
+	BigInt_t<SIZE, ALLOC> res;
+	res.data.resize(k + l);
+	intvec ws(kara_scratch(std::max(k, l), par));
+
+	if (a == b && ae == be)
+		kara_sqr(res.get_ptr(), a, k, ws.data(), par);
+	else if (k >= l)
+		kara_mul(res.get_ptr(), a, k, b, l, ws.data(), par);
+	else
+		kara_mul(res.get_ptr(), b, l, a, k, ws.data(), par);
+
+	res.sgn = 1;
+	return res;
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::mul_basecase(buip r, buicp a, size_t k, buicp b, size_t l) {
+	std::fill(r, r + l, bui(0));
+	for (size_t i = 0; i < k; ++i) {
+		r[i + l] = addmul_1(r + i, b, l, a[i]);
+	}
+}
+
+//each product a[i]*a[j], i != j, is computed once and doubled, then the squares a[i]^2 are added
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::sqr_basecase(buip r, buicp a, size_t n) {
+	lui tmp;
+	bui carry;
+	std::fill(r, r + 2 * n, bui(0));
+	for (size_t i = 0; i + 1 < n; ++i) {
+		carry = 0;
+		for (size_t j = i + 1; j < n; ++j) {
+			tmp = (lui)a[i] * a[j] + (lui)r[i + j] + carry;
+			carry = (bui)(tmp >> SOI);
+			r[i + j] = tmp & C_MAX_DIG;
+		}
+		r[i + n] = carry;
+	}
+
+	bui hb = 0;
+	for (size_t i = 0; i < 2 * n; ++i) {
+		bui val = r[i];
+		r[i] = (bui)(val << 1) | hb;
+		hb = val >> SOI_1;
+	}
+
+	unsigned char c = 0;
+	for (size_t i = 0; i < n; ++i) {
+		tmp = (lui)a[i] * a[i];
+		c = addcarry(c, r[2 * i], (bui)(tmp & C_MAX_DIG), &r[2 * i]);
+		c = addcarry(c, r[2 * i + 1], (bui)(tmp >> SOI), &r[2 * i + 1]);
+	}
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::mul_1(buip r, buicp a, size_t n, bui b, bui c) {
+	for (size_t i = 0; i < n; ++i) {
+		lui tmp = (lui)a[i] * b + c;
+		c = (bui)(tmp >> SOI);
+		r[i] = (bui)(tmp & C_MAX_DIG);
+	}
+	return c;
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::addmul_1(buip r, buicp a, size_t n, bui b) {
+	bui carry = 0;
+	for (size_t i = 0; i < n; ++i) {
+		lui tmp = (lui)a[i] * b + r[i] + carry;
+		carry = (bui)(tmp >> SOI);
+		r[i] = (bui)(tmp & C_MAX_DIG);
+	}
+	return carry;
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::submul_1(buip r, buicp a, size_t n, bui b) {
+	bui borrow = 0;
+	for (size_t i = 0; i < n; ++i) {
+		lui tmp = (lui)a[i] * b + borrow;
+		bui lo = (bui)(tmp & C_MAX_DIG);
+		borrow = (bui)(tmp >> SOI) + (r[i] < lo);
+		r[i] -= lo;
+	}
+	return borrow;
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::add_n(buip r, buicp a, buicp b, size_t n) {
+	unsigned char carry = 0;
+	for (size_t i = 0; i < n; ++i) {
+		carry = addcarry(carry, a[i], b[i], &r[i]);
+	}
+	return carry;
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::sub_n(buip r, buicp a, buicp b, size_t n) {
+	unsigned char borrow = 0;
+	for (size_t i = 0; i < n; ++i) {
+		borrow = subborrow(borrow, a[i], b[i], &r[i]);
+	}
+	return borrow;
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::add_1(buip r, buicp a, size_t n, bui c) {
+	size_t i = 0;
+	for (; i < n && c; ++i) {
+		r[i] = a[i] + c;
+		c = r[i] < c;
+	}
+	if (r != a)
+		std::copy(a + i, a + n, r + i);
+	return c;
+}
+
+template<int SIZE, class ALLOC>
+bool BigInt_t<SIZE, ALLOC>::abs_diff(buip r, buicp a, size_t n, buicp b, size_t m) {
+	bool less = std::all_of(a + m, a + n, [](bui x) { return x == 0; });
+	if (less) {
+		size_t i = m;
+		while (i > 0 && a[i - 1] == b[i - 1])
+			--i;
+		less = i > 0 && a[i - 1] < b[i - 1];
+	}
+
+	if (less) {
+		sub_n(r, b, a, m);
+		std::fill(r + m, r + n, bui(0));
+	}
+	else {
+		bui borrow = sub_n(r, a, b, m);
+		for (size_t i = m; i < n; ++i) {
+			r[i] = a[i] - borrow;
+			borrow = a[i] < borrow;
+		}
+	}
+	return less;
+}
+
+template<int SIZE, class ALLOC>
+char BigInt_t<SIZE, ALLOC>::cmp_n(buicp a, buicp b, size_t n) {
+	for (size_t i = n; i-- > 0;) {
+		if (a[i] != b[i])
+			return a[i] < b[i] ? -1 : 1;
+	}
+	return 0;
+}
+
+//scratch for the level with operands of k limbs is 4 * ceil(k / 2) limbs plus the scratch of the next level.
+//Parallel top level needs separate scratch for each of its three products
+template<int SIZE, class ALLOC>
+size_t BigInt_t<SIZE, ALLOC>::kara_scratch(size_t k, bool par) {
+	const size_t limit = KARATSUBA_LIMIT < SQR_KARATSUBA_LIMIT ? KARATSUBA_LIMIT : SQR_KARATSUBA_LIMIT;
+	if (par)
+		return kara_scratch(k) + 2 * kara_scratch((k + 1) >> 1);
+	size_t s = 0;
+	while (k >= limit) {
+		k = (k + 1) >> 1;
+		s += 4 * k;
+	}
+	return s;
+}
+
+// a = a1 x + a0, b = b1 x + b0, x = 2^(SOI * h)
+// a * b = a1 b1 x^2 + (a0 b0 + a1 b1 - (a0 - a1)(b0 - b1)) x + a0 b0
+//the differences are taken by absolute value, so no carry limbs appear
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::kara_mul(buip r, buicp a, size_t k, buicp b, size_t l, buip ws, bool par) {
+	if (l < KARATSUBA_LIMIT) {
+		mul_basecase(r, a, k, b, l);
+		return;
+	}
+
+	size_t h = (k + 1) >> 1;
+	if (l <= h) {
+		//unbalanced operands: a is cut into pieces of l limbs, the products are accumulated in r
+		kara_mul(r, a, l, b, l, ws);
+		std::fill(r + 2 * l, r + k + l, bui(0));
+		for (size_t i = l; i < k; i += l) {
+			size_t len = std::min(l, k - i);
+			kara_mul(ws, b, l, a + i, len, ws + 2 * l);
+			add_n(r + i, r + i, ws, len + l);
+		}
+		return;
+	}
+
+	size_t hl = k + l - 2 * h;
+	buip da = ws, db = ws + h, p = ws + 2 * h, nws = ws + 4 * h;
+	bool neg = abs_diff(da, a, h, a + h, k - h) != abs_diff(db, b, h, b + h, l - h);
+
+	if (par) {
+		size_t s = kara_scratch(h);
+		std::vector<std::function<void()>> tasks = {
+			[=]() { kara_mul(p, da, h, db, h, nws); },
+			[=]() { kara_mul(r, a, h, b, h, nws + s); },
+			[=]() { kara_mul(r + 2 * h, a + h, k - h, b + h, l - h, nws + 2 * s); }
+		};
+		BigIntUtility::thread_pool().run(tasks);
+	}
+	else {
+		kara_mul(p, da, h, db, h, nws);
+		kara_mul(r, a, h, b, h, nws);
+		kara_mul(r + 2 * h, a + h, k - h, b + h, l - h, nws);
+	}
+
+	//p = a0 b0 + a1 b1 -+ |a0 - a1| |b0 - b1| with cy high limb
+	int cy = neg ? (int)add_n(p, p, r, 2 * h) : -(int)sub_n(p, r, p, 2 * h);
+	cy += (int)add_1(p + hl, p + hl, 2 * h - hl, add_n(p, p, r + 2 * h, hl));
+
+	bui c = add_n(r + h, r + h, p, 2 * h);
+	add_1(r + 3 * h, r + 3 * h, k + l - 3 * h, bui(c + cy));
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::kara_sqr(buip r, buicp a, size_t n, buip ws, bool par) {
+	if (n < SQR_KARATSUBA_LIMIT) {
+		sqr_basecase(r, a, n);
+		return;
+	}
+
+	size_t h = (n + 1) >> 1, hl = 2 * (n - h);
+	buip da = ws, p = ws + 2 * h, nws = ws + 4 * h;
+	abs_diff(da, a, h, a + h, n - h);
+
+	if (par) {
+		size_t s = kara_scratch(h);
+		std::vector<std::function<void()>> tasks = {
+			[=]() { kara_sqr(p, da, h, nws); },
+			[=]() { kara_sqr(r, a, h, nws + s); },
+			[=]() { kara_sqr(r + 2 * h, a + h, n - h, nws + 2 * s); }
+		};
+		BigIntUtility::thread_pool().run(tasks);
+	}
+	else {
+		kara_sqr(p, da, h, nws);
+		kara_sqr(r, a, h, nws);
+		kara_sqr(r + 2 * h, a + h, n - h, nws);
+	}
+
+	int cy = -(int)sub_n(p, r, p, 2 * h);
+	cy += (int)add_1(p + hl, p + hl, 2 * h - hl, add_n(p, p, r + 2 * h, hl));
+
+	bui c = add_n(r + h, r + h, p, 2 * h);
+	add_1(r + 3 * h, r + 3 * h, 2 * n - 3 * h, bui(c + cy));
+}
+
+//Toom-3: evaluation in 0, 1, -1, -2, inf, interpolation sequence by M. Bodrato
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::mult_toom3(buicp a, buicp ae, buicp b, buicp be) {
+	size_t k = size_t(ae - a), l = size_t(be - b);
+	size_t p = (std::max(k, l) + 2) / 3;
+
+	BigInt_t<SIZE, ALLOC> A[3], B[3];
+	for (size_t i = 0; i < 3; ++i) {
+		A[i] = piece(a, ae, i, p);
+		B[i] = piece(b, be, i, p);
+	}
+
+	// x(1), x(-1), x(-2) for polynomial X
+	auto eval = [](const BigInt_t<SIZE, ALLOC> * X, BigInt_t<SIZE, ALLOC> * v) {
+		v[0] = X[0] + X[2];
+		v[1] = v[0] - X[1];
+		v[0] += X[1];
+		v[2] = ((v[1] + X[2]) <<= 1) - X[0];
+	};
+	//on squaring the second polynomial is the same object, so the products below are squares
+	BigInt_t<SIZE, ALLOC> va[3], vb[3];
+	auto pb = B, pvb = vb;
+	eval(A, va);
+	if (a == b && ae == be) {
+		pb = A;
+		pvb = va;
+	}
+	else {
+		eval(B, vb);
+	}
+
+	BigInt_t<SIZE, ALLOC> v[5];
+	const BigInt_t<SIZE, ALLOC> * x[] = { &A[0], &va[0], &va[1], &va[2], &A[2] };
+	const BigInt_t<SIZE, ALLOC> * y[] = { &pb[0], &pvb[0], &pvb[1], &pvb[2], &pb[2] };
+	mult_many(v, x, y, 5, parallel(std::min(k, l)));
+	auto & v0 = v[0], & v1 = v[1], & vm1 = v[2], & vm2 = v[3], & vinf = v[4];
+
+	auto & r3 = div_exact_1(vm2 -= v1, 3);
+	auto & r1 = (v1 -= vm1) >>= 1;
+	auto & r2 = vm1 -= v0;
+	(r3 = (r2 - r3) >>= 1) += vinf << 1;
+	(r2 += r1) -= vinf;
+	r1 -= r3;
+
+	BigInt_t<SIZE, ALLOC> res = v0;
+	res.data.resize(k + l, 0);
+	addAbs(res, r1, p);
+	addAbs(res, r2, 2 * p);
+	addAbs(res, r3, 3 * p);
+	addAbs(res, vinf, 4 * p);
+	return res.normalize();
+}
+
+//Toom-4: evaluation in 0, 1, -1, 2, -2, 3, inf
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::mult_toom4(buicp a, buicp ae, buicp b, buicp be) {
+	size_t k = size_t(ae - a), l = size_t(be - b);
+	size_t p = (std::max(k, l) + 3) / 4;
+
+	BigInt_t<SIZE, ALLOC> A[4], B[4];
+	for (size_t i = 0; i < 4; ++i) {
+		A[i] = piece(a, ae, i, p);
+		B[i] = piece(b, be, i, p);
+	}
+
+	// x(1), x(-1), x(2), x(-2), x(3) for polynomial X
+	auto eval = [](const BigInt_t<SIZE, ALLOC> * X, BigInt_t<SIZE, ALLOC> * v) {
+		auto ev = X[0] + X[2], od = X[1] + X[3];
+		v[0] = ev + od;
+		v[1] = ev - od;
+		ev = X[0] + (X[2] << 2);
+		od = (X[1] + (X[3] << 2)) <<= 1;
+		v[2] = ev + od;
+		v[3] = ev - od;
+		v[4] = X[3];
+		for (int i = 2; i >= 0; --i) {
+			(v[4] *= 3) += X[i];
+		}
+	};
+	//on squaring the second polynomial is the same object, so the products below are squares
+	BigInt_t<SIZE, ALLOC> va[5], vb[5];
+	auto pb = B, pvb = vb;
+	eval(A, va);
+	if (a == b && ae == be) {
+		pb = A;
+		pvb = va;
+	}
+	else {
+		eval(B, vb);
+	}
+
+	BigInt_t<SIZE, ALLOC> v[7];
+	const BigInt_t<SIZE, ALLOC> * x[] = { &A[0], &A[3], &va[0], &va[1], &va[2], &va[3], &va[4] };
+	const BigInt_t<SIZE, ALLOC> * y[] = { &pb[0], &pb[3], &pvb[0], &pvb[1], &pvb[2], &pvb[3], &pvb[4] };
+	mult_many(v, x, y, 7, parallel(std::min(k, l)));
+	auto & v0 = v[0], & vinf = v[1];
+	auto & W1 = v[2], & Wm1 = v[3], & W2 = v[4], & Wm2 = v[5], & W3 = v[6];
+
+	//W(x) = v(x) - v0 - vinf * x^6 = c1 x + c2 x^2 + c3 x^3 + c4 x^4 + c5 x^5
+	auto v0inf = v0 + vinf;
+	W1 -= v0inf;
+	Wm1 -= v0inf;
+	(W2 -= v0) -= vinf << 6;
+	(Wm2 -= v0) -= vinf << 6;
+	auto tmp = vinf;
+	(W3 -= v0) -= (tmp *= 27) *= 27;
+
+	// E1 = c2 + c4, O1 = c1 + c3 + c5
+	auto E1 = W1 + Wm1;
+	E1 >>= 1;
+	auto & O1 = (W1 -= Wm1) >>= 1;
+	// E2 = 4 c2 + 16 c4, O2 = c1 + 4 c3 + 16 c5
+	auto E2 = W2 + Wm2;
+	E2 >>= 1;
+	auto & O2 = (W2 -= Wm2) >>= 2;
+
+	auto & c4 = div_exact_1((E2 >>= 2) -= E1, 3);
+	auto & c2 = E1 -= c4;
+	// O3 = c1 + 9 c3 + 81 c5
+	W3 -= (tmp = c2) *= 9;
+	auto & O3 = div_exact_1(W3 -= (tmp = c4) *= 81, 3);
+
+	// T1 = c3 + 5 c5, T2 = c3 + 10 c5
+	auto & T1 = div_exact_1(O2 -= O1, 3);
+	auto & T2 = (O3 -= O1) >>= 3;
+	auto & c5 = div_exact_1(T2 -= T1, 5);
+	auto & c3 = T1 -= (tmp = c5) *= 5;
+	auto & c1 = (O1 -= c3) -= c5;
+
+	BigInt_t<SIZE, ALLOC> res = v0;
+	res.data.resize(k + l, 0);
+	addAbs(res, c1, p);
+	addAbs(res, c2, 2 * p);
+	addAbs(res, c3, 3 * p);
+	addAbs(res, c4, 4 * p);
+	addAbs(res, c5, 5 * p);
+	addAbs(res, vinf, 6 * p);
+	return res.normalize();
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::mult_ntt(buicp a, buicp ae, buicp b, buicp be) {
+	size_t k = size_t(ae - a), l = size_t(be - b);
+	BigInt_t<SIZE, ALLOC> res;
+	res.data.resize(k + l);
+	BigIntUtility::ntt_mult<bui>(res.get_ptr(), a, k, b, l, parallel(std::min(k, l)));
+	res.sgn = 1;
+	return res;
+}
+
+//Toom-2.5: a = a2 x^2 + a1 x + a0, b = b1 x + b0, evaluation in 0, 1, -1, inf
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::mult_toom32(buicp a, buicp ae, buicp b, buicp be) {
+	size_t k = size_t(ae - a), l = size_t(be - b);
+	size_t p = std::max((k + 2) / 3, (l + 1) / 2);
+
+	BigInt_t<SIZE, ALLOC> A[3], B[2];
+	for (size_t i = 0; i < 3; ++i)
+		A[i] = piece(a, ae, i, p);
+	for (size_t i = 0; i < 2; ++i)
+		B[i] = piece(b, be, i, p);
+
+	auto ev = A[0] + A[2];
+	BigInt_t<SIZE, ALLOC> va[2] = { ev + A[1], ev - A[1] }, vb[2] = { B[0] + B[1], B[0] - B[1] };
+
+	BigInt_t<SIZE, ALLOC> v[4];
+	const BigInt_t<SIZE, ALLOC> * x[] = { &A[0], &va[0], &va[1], &A[2] };
+	const BigInt_t<SIZE, ALLOC> * y[] = { &B[0], &vb[0], &vb[1], &B[1] };
+	mult_many(v, x, y, 4, parallel(std::min(k, l)));
+	auto & v0 = v[0], & v1 = v[1], & vm1 = v[2], & vinf = v[3];
+
+	// c0 + c2 = (v1 + vm1) / 2, c1 + c3 = (v1 - vm1) / 2
+	auto c2 = v1 + vm1;
+	(c2 >>= 1) -= v0;
+	auto & c1 = ((v1 -= vm1) >>= 1) -= vinf;
+
+	BigInt_t<SIZE, ALLOC> res = v0;
+	res.data.resize(k + l, 0);
+	addAbs(res, c1, p);
+	addAbs(res, c2, 2 * p);
+	addAbs(res, vinf, 3 * p);
+	return res.normalize();
+}
+
+//a = a3 x^3 + a2 x^2 + a1 x + a0, b = b1 x + b0, evaluation in 0, 1, -1, 2, inf
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::mult_toom42(buicp a, buicp ae, buicp b, buicp be) {
+	size_t k = size_t(ae - a), l = size_t(be - b);
+	size_t p = std::max((k + 3) / 4, (l + 1) / 2);
+
+	BigInt_t<SIZE, ALLOC> A[4], B[2];
+	for (size_t i = 0; i < 4; ++i)
+		A[i] = piece(a, ae, i, p);
+	for (size_t i = 0; i < 2; ++i)
+		B[i] = piece(b, be, i, p);
+
+	auto ev = A[0] + A[2], od = A[1] + A[3];
+	BigInt_t<SIZE, ALLOC> va[3] = { ev + od, ev - od, A[3] };
+	for (int i = 2; i >= 0; --i)
+		(va[2] <<= 1) += A[i];
+	BigInt_t<SIZE, ALLOC> vb[3] = { B[0] + B[1], B[0] - B[1], B[0] + (B[1] << 1) };
+
+	BigInt_t<SIZE, ALLOC> v[5];
+	const BigInt_t<SIZE, ALLOC> * x[] = { &A[0], &va[0], &va[1], &va[2], &A[3] };
+	const BigInt_t<SIZE, ALLOC> * y[] = { &B[0], &vb[0], &vb[1], &vb[2], &B[1] };
+	mult_many(v, x, y, 5, parallel(std::min(k, l)));
+	auto & v0 = v[0], & v1 = v[1], & vm1 = v[2], & v2 = v[3], & vinf = v[4];
+
+	// c0 + c2 + c4 = (v1 + vm1) / 2, c1 + c3 = (v1 - vm1) / 2, v2 = c0 + 2 c1 + 4 c2 + 8 c3 + 16 c4
+	auto c2 = v1 + vm1;
+	((c2 >>= 1) -= v0) -= vinf;
+	auto & o = (v1 -= vm1) >>= 1;
+	auto & c3 = div_exact_1(((((v2 -= v0) -= c2 << 2) -= vinf << 4) -= o << 1) >>= 1, 3);
+	auto & c1 = o -= c3;
+
+	BigInt_t<SIZE, ALLOC> res = v0;
+	res.data.resize(k + l, 0);
+	addAbs(res, c1, p);
+	addAbs(res, c2, 2 * p);
+	addAbs(res, c3, 3 * p);
+	addAbs(res, vinf, 4 * p);
+	return res.normalize();
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::mult_to(buip r, buicp a, buicp ae, buicp b, buicp be) {
+	size_t k = size_t(ae - a), l = size_t(be - b);
+	if (std::min(k, l) < TOOM3_LIMIT) {
+		intvec ws(kara_scratch(std::max(k, l)));
+		if (a == b && ae == be)
+			kara_sqr(r, a, k, ws.data());
+		else if (k >= l)
+			kara_mul(r, a, k, b, l, ws.data());
+		else
+			kara_mul(r, b, l, a, k, ws.data());
+		return;
+	}
+
+	auto t = mult(a, ae, b, be, 1);
+	std::copy(t.data.begin(), t.data.end(), r);
+	std::fill(r + t.dig(), r + k + l, bui(0));
+}
+
+template<int SIZE, class ALLOC>
+size_t BigInt_t<SIZE, ALLOC>::mult_wrap(intvec & r, size_t n, buicp a, size_t k, buicp b, size_t l) {
+	size_t N = BigIntUtility::ntt_wrap_size<bui>(n);
+	if (std::min(k, l) >= NTT_LIMIT && BigIntUtility::ntt_wrap_fits<bui>(N)) {
+		r.resize(N);
+		BigIntUtility::ntt_mult_wrap<bui>(r.data(), N, a, k, b, l, parallel(std::min(k, l)));
+		return N;
+	}
+
+	intvec p(k + l);
+	mult_to(p.data(), a, a + k, b, b + l);
+	r.assign(n, 0);
+	for (size_t i = 0; i < k + l; i += n)
+		add_wrap(r.data(), n, p.data() + i, std::min(n, k + l - i));
+	return n;
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::add_wrap(buip r, size_t N, buicp a, size_t len) {
+	bui c = add_n(r, r, a, len);
+	if (c && len < N)
+		c = add_1(r + len, r + len, N - len, c);
+	//B^N = 1
+	while (c)
+		c = add_1(r, r, N, c);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::from_wrap(const intvec & r) {
+	BigInt_t<SIZE, ALLOC> x(1, r);
+	//with the highest bit set r is x + B^N - 1 for a negative x, and -x = B^N - 1 - r = ~r
+	if (r.back() >> SOI_1) {
+		for (auto & v : x.data)
+			v = bui(~v);
+		x.sgn = -1;
+	}
+	return x.normalize();
+}
+
+template<int SIZE, class ALLOC>
+bool BigInt_t<SIZE, ALLOC>::parallel(size_t n) {
+	//memory of a scoped allocator can't be used by other threads
+	return !ALLOC::SCOPED && n >= parallelLimit && BigIntUtility::thread_pool().size() > 0;
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::set_threads(size_t n) {
+	BigIntUtility::thread_pool().resize(n);
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::mult_many(BigInt_t<SIZE, ALLOC> * res, const BigInt_t<SIZE, ALLOC> * const * x, const BigInt_t<SIZE, ALLOC> * const * y, size_t cnt, bool par) {
+	if (!par) {
+		for (size_t i = 0; i < cnt; ++i)
+			res[i] = *x[i] * *y[i];
+		return;
+	}
+	std::vector<std::function<void()>> tasks;
+	for (size_t i = 0; i < cnt; ++i)
+		tasks.push_back([=]() { res[i] = *x[i] * *y[i]; });
+	BigIntUtility::thread_pool().run(tasks);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::sqr(buicp a, buicp ae) {
+	size_t k = size_t(ae - a);
+	if (!k)
+		return BigInt_t<SIZE, ALLOC>();
+
+	BigInt_t<SIZE, ALLOC> res;
+	if (k < SQR_KARATSUBA_LIMIT) {
+		res = sqr_school(a, ae);
+	}
+	else if (k >= SQR_NTT_LIMIT && BigIntUtility::ntt_fits<bui>(k, k)) {
+		res = mult_ntt(a, ae, a, ae);
+	}
+	else if (k >= SQR_TOOM4_LIMIT) {
+		res = mult_toom4(a, ae, a, ae);
+	}
+	else if (k >= SQR_TOOM3_LIMIT) {
+		res = mult_toom3(a, ae, a, ae);
+	}
+	else {
+		res = mult_karatsuba(a, ae, a, ae);
+	}
+
+	res.sgn = 1;
+	return res;
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::sqr_school(buicp a, buicp ae) {
+	size_t k = size_t(ae - a);
+	BigInt_t<SIZE, ALLOC> res;
+	res.data.resize(2 * k);
+	sqr_basecase(res.get_ptr(), a, k);
+	res.sgn = 1;
+	return res;
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::piece(buicp a, buicp ae, size_t i, size_t len) {
+	size_t n = size_t(ae - a);
+	BigInt_t<SIZE, ALLOC> res;
+	if (i * len < n) {
+		res.data.assign(a + i * len, a + std::min((i + 1) * len, n));
+		res.sgn = 1;
+		res.normalize();
+	}
+	return res;
+}
+
+//d is normalized by a shift s and the limbs of a are shifted on the fly,
+//the quotient doesn't change and the remainder is shifted back
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::div_1(buip q, buicp a, size_t n, bui d) {
+	int s = SOI - 1 - BigIntUtility::_log2(d);
+	bui dn = bui(d << s);
+	return div_1_preinv(q, a, n, dn, reciprocal_1(dn), s);
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::div_1_preinv(buip q, buicp a, size_t n, bui dn, bui v, int s) {
+	if (!n)
+		return 0;
+	bui r = 0;
+	if (s == 0) {
+		for (size_t i = n; i-- > 0;)
+			q[i] = div_limb_preinv(r, a[i], dn, v);
+		return r;
+	}
+
+	r = bui(a[n - 1] >> (SOI - s));
+	for (size_t i = n; i-- > 0;) {
+		bui u0 = bui(a[i] << s) | (i ? bui(a[i - 1] >> (SOI - s)) : bui(0));
+		q[i] = div_limb_preinv(r, u0, dn, v);
+	}
+	return bui(r >> s);
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::reciprocal_1(bui d) {
+	return bui(lui(~lui(0) - (lui(d) << SOI)) / d);
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::reciprocal_2(bui d1, bui d0) {
+	//the reciprocal of d1 is corrected by the contribution of d0
+	bui v = reciprocal_1(d1), p = bui(d1 * v + d0);
+	if (p < d0) {
+		--v;
+		if (p >= d1) {
+			--v;
+			p = bui(p - d1);
+		}
+		p = bui(p - d1);
+	}
+	lui t = lui(d0) * v;
+	bui t1 = bui(t >> SOI), t0 = bui(t);
+	p = bui(p + t1);
+	if (p < t1) {
+		--v;
+		if (p > d1 || (p == d1 && t0 >= d0))
+			--v;
+	}
+	return v;
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::reciprocal_top(const BigInt_t<SIZE, ALLOC> & d) {
+	size_t l = d.dig();
+	return l == 1 ? reciprocal_1(d[0]) : reciprocal_2(d[l - 1], d[l - 2]);
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::div_3by2_preinv(bui n2, bui n1, bui n0, bui d1, bui d0, bui v, bui & r1, bui & r0) {
+	lui p = lui(v) * n2 + ((lui(n2) << SOI) | n1), D = (lui(d1) << SOI) | d0;
+	bui q = bui(p >> SOI), q0 = bui(p);
+	//the remainder is computed modulo B^2 for the estimate q + 1, which is 1 too big or exact
+	lui r = lui(((lui(bui(n1 - d1 * q)) << SOI) | n0) - D - lui(d0) * q);
+	q = bui(q + 1);
+	if (bui(r >> SOI) >= q0) {
+		q = bui(q - 1);
+		r = lui(r + D);
+	}
+	if (r >= D) {
+		q = bui(q + 1);
+		r = lui(r - D);
+	}
+	r1 = bui(r >> SOI);
+	r0 = bui(r);
+	return q;
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::div_limb_preinv(bui & u1, bui u0, bui d, bui v) {
+	lui p = lui(v) * u1 + ((lui(u1) << SOI) | u0);
+	bui q = bui((p >> SOI) + 1), r = bui(u0 - q * d);
+	//r is computed modulo B: the estimate q is either exact or 1 too big, rarely 1 too small
+	if (r > bui(p)) {
+		--q;
+		r = bui(r + d);
+	}
+	if (r >= d) {
+		++q;
+		r = bui(r - d);
+	}
+	u1 = r;
+	return q;
+}
+
+//for odd d the limbs of quotient are found from the lowest one: q[i] = (a[i] - c) / d mod B,
+//where c is the high limb of q[i - 1] * d plus the borrow
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::div_exact_1(BigInt_t<SIZE, ALLOC> & a, bui d) {
+	if (d % 2 == 0) {
+		div_1(a.get_ptr(), a.get_ptr(), a.dig(), d);
+		return a.normalize();
+	}
+
+	bui inv = inverse_1(d), c = 0;
+	for (auto & el : a.data) {
+		bui borrow = el < c;
+		el = bui(bui(el - c) * inv);
+		c = bui(bui((lui(el) * d) >> SOI) + borrow);
+	}
+	return a.normalize();
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::inverse_1(bui d) {
+	//d * d = 1 mod 8, each Newton step doubles the number of correct bits
+	bui x = d;
+	for (int bits = 3; bits < SOI; bits *= 2)
+		x = bui(x * bui(2 - d * x));
+	return x;
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::add_abs_ptr(BigInt_t<SIZE, ALLOC> & a, buicp b, buicp be, long long bigShiftB)
 {
 	if (be - b == 0) {
 		if (a.isNeg())
@@ -860,8 +2283,8 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::add_abs_ptr(BigInt_t<SIZE> & a, buicp b, buicp
 	return a;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::sub_abs_ptr(BigInt_t<SIZE> & a, buicp b, buicp be, long long bigShiftB) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::sub_abs_ptr(BigInt_t<SIZE, ALLOC> & a, buicp b, buicp be, long long bigShiftB) {
 	auto sh = (size_t)std::min(bigShiftB, (long long)(a.data.size()));
 	auto ita = a.data.begin() + sh;
 	auto de = b + std::min(be - b, a.data.end() - ita);
@@ -900,61 +2323,107 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::sub_abs_ptr(BigInt_t<SIZE> & a, buicp b, buicp
 	return a;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator + (const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator + (const BigInt_t<SIZE, ALLOC> & a) const & {
 	auto r = *this;
-	return r += a;
+	r += a;
+	return r;
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator + (const BigInt_t<SIZE, ALLOC> & a) && {
+	*this += a;
+	return std::move(*this);
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator - (const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator + (BigInt_t<SIZE, ALLOC> && a) const & {
+	a += *this;
+	return std::move(a);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator + (BigInt_t<SIZE, ALLOC> && a) && {
+	*this += a;
+	return std::move(*this);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator - (const BigInt_t<SIZE, ALLOC> & a) const & {
 	auto r = *this;
-	return r -= a;
+	r -= a;
+	return r;
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator - (const BigInt_t<SIZE, ALLOC> & a) && {
+	*this -= a;
+	return std::move(*this);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator - (BigInt_t<SIZE, ALLOC> && a) const & {
+	// *this - a = -(a - *this)
+	a -= *this;
+	a.negate();
+	return std::move(a);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator - (BigInt_t<SIZE, ALLOC> && a) && {
+	*this -= a;
+	return std::move(*this);
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator - () const {
-	BigInt_t<SIZE> a(*this);
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator - () const & {
+	BigInt_t<SIZE, ALLOC> a(*this);
 	a.negate();
 	return a;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator += (const BigInt_t<SIZE> & a) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator - () && {
+	negate();
+	return std::move(*this);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator += (const BigInt_t<SIZE, ALLOC> & a) {
 	return addSign(*this, a, 1);
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator -= (const BigInt_t<SIZE> & a) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator -= (const BigInt_t<SIZE, ALLOC> & a) {
 	return addSign(*this, a, -1);
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator ++ () {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator ++ () {
 	return addSign(*this, 1, 1);
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator ++ (int) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator ++ (int) {
 	auto a = *this;
 	++*this;
 	return a;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator -- () {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator -- () {
 	return addSign(*this, 1, -1);
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator -- (int) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator -- (int) {
 	auto a = *this;
 	--*this;
 	return a;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::big_shift(long long n) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::big_shift(long long n) {
 	if (n > 0)
 		data.insert(data.begin(), (size_t)n, 0);
 	else if (n < 0)
@@ -962,27 +2431,29 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::big_shift(long long n) {
 	return *this;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator >> (long long n) const {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator >> (long long n) const {
 	auto a(*this);
 	return a >>= n;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator << (long long n) const {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator << (long long n) const {
 	auto a(*this);
 	return a <<= n;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator >>= (long long n) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator >>= (long long n) {
 	auto skip = n >> LOG_SOI;
 	int k = n & SOI_1;
 	int soi_k = SOI - k;
-	bui lowest = (1 << k) - 1;
+	bui lowest = bui(((bui)1 << k) - 1);
 	bui hb = 0, lb = 0;
 
 	big_shift(-skip);
+	if (k == 0)
+		return normalize();
 	auto it = data.begin();
 	if (it != data.end())
 		for (;;) {
@@ -1001,14 +2472,14 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::operator >>= (long long n) {
 	return normalize();
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator <<= (long long n) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator <<= (long long n) {
 	if (isNull()) return *this;
 
 	auto skip = n >> LOG_SOI;
 	int k = n & SOI_1;
 	int soi_k = SOI - k;
-	bui lowest = (1 << soi_k) - 1;
+	bui lowest = bui(C_MAX_DIG >> k);
 	bui hb = 0, lb = 0;
 
 	big_shift(skip);
@@ -1025,61 +2496,108 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::operator <<= (long long n) {
 	return normalize();
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator >> (int n) const {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator >> (int n) const {
 	return *this >> (long long)n;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator >>= (int n) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator >>= (int n) {
 	return *this >>= (long long)n;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator << (int n) const {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator << (int n) const {
 	return *this << (long long)n;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator <<= (int n) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator <<= (int n) {
 	return *this <<= (long long)n;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> operator * (typename BigInt_t<SIZE>::bui a, const BigInt_t<SIZE> & b) {
-	BigInt_t<SIZE> res(b);
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> operator * (typename BigInt_t<SIZE, ALLOC>::bui a, const BigInt_t<SIZE, ALLOC> & b) {
+	BigInt_t<SIZE, ALLOC> res(b);
 	res *= a;
 	return res;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> operator * (const BigInt_t<SIZE> & b, typename BigInt_t<SIZE>::bui a) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> operator * (const BigInt_t<SIZE, ALLOC> & b, typename BigInt_t<SIZE, ALLOC>::bui a) {
 	return a*b;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator * (const BigInt_t<SIZE> & a) const {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator * (const BigInt_t<SIZE, ALLOC> & a) const {
+	if (this == &a)
+		return square();
 
 	return mult(get_ptr(), get_ptr() + dig(), a.get_ptr(), a.get_ptr() + a.dig(), sgn*a.sgn).normalize();
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator *= (const BigInt_t<SIZE> & a) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator *= (const BigInt_t<SIZE, ALLOC> & a) {
 	return *this = *this * a;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator *= (const bui a)
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::square() const {
+	return sqr(get_ptr(), get_ptr() + dig()).normalize();
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::multiply(const BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b, MultMethod method) {
+	if (a.isNull() || b.isNull())
+		return BigInt_t<SIZE, ALLOC>();
+
+	auto ap = a.get_ptr(), bp = b.get_ptr();
+	auto ae = ap + a.dig(), be = bp + b.dig();
+	BigInt_t<SIZE, ALLOC> res;
+	switch (method)
+	{
+	case MultMethod::SCHOOLBOOK:
+		res = mult_school(ap, ae, bp, be);
+		break;
+	case MultMethod::KARATSUBA:
+		res = mult_karatsuba(ap, ae, bp, be);
+		break;
+	case MultMethod::TOOM3:
+		res = mult_toom3(ap, ae, bp, be);
+		break;
+	case MultMethod::TOOM4:
+		res = mult_toom4(ap, ae, bp, be);
+		break;
+	case MultMethod::TOOM32:
+		res = mult_toom32(ap, ae, bp, be);
+		break;
+	case MultMethod::TOOM42:
+		res = mult_toom42(ap, ae, bp, be);
+		break;
+	case MultMethod::NTT:
+		if (!BigIntUtility::ntt_fits<bui>(a.dig(), b.dig()))
+			return a * b;
+		res = mult_ntt(ap, ae, bp, be);
+		break;
+	default:
+		return a * b;
+	}
+	res.sgn = a.sgn * b.sgn;
+	return res.normalize();
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator *= (const bui a)
 {
 	if (a == 0 || isNull())
-		return *this = BigInt_t<SIZE>();
+		return *this = BigInt_t<SIZE, ALLOC>();
 
 	lui carry = 0, A = (lui)a;
 
 	for (auto & el : data) {
 		lui r = carry + el * A;
-		carry = r >> BigInt_t<SIZE>::SOI;
-		el = (bui)(r & BigInt_t<SIZE>::C_MAX_DIG);
+		carry = r >> BigInt_t<SIZE, ALLOC>::SOI;
+		el = (bui)(r & BigInt_t<SIZE, ALLOC>::C_MAX_DIG);
 	}
 
 	if (carry > 0) {
@@ -1088,8 +2606,95 @@ BigInt_t<SIZE> & BigInt_t<SIZE>::operator *= (const bui a)
 	return *this;
 }
 
-template<int SIZE>
-void BigInt_t<SIZE>::div(const BigInt_t<SIZE> & d, BigInt_t<SIZE> & Q, BigInt_t<SIZE> & R) const
+//r gets a spare top limb, so r + sign * a * b is computed modulo its length in two's complement
+//and the sign of the result is the highest bit
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::mul_acc(BigInt_t<SIZE, ALLOC> & r, buicp a, size_t n, buicp b, size_t m, char sign) {
+	if (n < m) {
+		std::swap(a, b);
+		std::swap(n, m);
+	}
+	if (r.isNull())
+		r.sgn = sign;
+	bool sub = r.sgn != sign;
+	size_t len = std::max(r.dig(), n + m) + 1;
+	r.data.resize(len, 0);
+	buip rp = r.get_ptr();
+
+	//adds (subtracts) the carry (borrow) c from r[i, len)
+	auto propagate = [&](size_t i, bui c) {
+		for (; c && i < len; ++i) {
+			bui x = rp[i];
+			rp[i] = sub ? bui(x - c) : bui(x + c);
+			c = sub ? bui(x < c) : bui(rp[i] < c);
+		}
+	};
+	if (m < KARATSUBA_LIMIT) {
+		for (size_t j = 0; j < m; ++j)
+			propagate(j + n, sub ? submul_1(rp + j, a, n, b[j]) : addmul_1(rp + j, a, n, b[j]));
+	}
+	else {
+		intvec p(n + m);
+		mult_to(p.data(), a, a + n, b, b + m);
+		propagate(n + m, sub ? sub_n(rp, rp, p.data(), n + m) : add_n(rp, rp, p.data(), n + m));
+	}
+
+	if (sub && (rp[len - 1] >> SOI_1)) {
+		//negative: two's complement back to the absolute value
+		for (size_t i = 0; i < len; ++i)
+			rp[i] = bui(~rp[i]);
+		add_1(rp, rp, len, 1);
+		r.negate();
+	}
+	return r.normalize();
+}
+
+template<int _SIZE, class _ALLOC>
+BigInt_t<_SIZE, _ALLOC> & addmul(BigInt_t<_SIZE, _ALLOC> & r, const BigInt_t<_SIZE, _ALLOC> & a, const BigInt_t<_SIZE, _ALLOC> & b) {
+	if (a.isNull() || b.isNull())
+		return r;
+	if (&r == &a || &r == &b) {
+		BigInt_t<_SIZE, _ALLOC> t(r);
+		return addmul(r, &r == &a ? t : a, &r == &b ? t : b);
+	}
+	return BigInt_t<_SIZE, _ALLOC>::mul_acc(r, a.get_ptr(), a.dig(), b.get_ptr(), b.dig(), a.sgn * b.sgn);
+}
+
+template<int _SIZE, class _ALLOC>
+BigInt_t<_SIZE, _ALLOC> & submul(BigInt_t<_SIZE, _ALLOC> & r, const BigInt_t<_SIZE, _ALLOC> & a, const BigInt_t<_SIZE, _ALLOC> & b) {
+	if (a.isNull() || b.isNull())
+		return r;
+	if (&r == &a || &r == &b) {
+		BigInt_t<_SIZE, _ALLOC> t(r);
+		return submul(r, &r == &a ? t : a, &r == &b ? t : b);
+	}
+	return BigInt_t<_SIZE, _ALLOC>::mul_acc(r, a.get_ptr(), a.dig(), b.get_ptr(), b.dig(), -a.sgn * b.sgn);
+}
+
+template<int _SIZE, class _ALLOC>
+BigInt_t<_SIZE, _ALLOC> & addmul(BigInt_t<_SIZE, _ALLOC> & r, const BigInt_t<_SIZE, _ALLOC> & a, typename BigInt_t<_SIZE, _ALLOC>::bui b) {
+	if (a.isNull() || b == 0)
+		return r;
+	if (&r == &a) {
+		BigInt_t<_SIZE, _ALLOC> t(r);
+		return addmul(r, t, b);
+	}
+	return BigInt_t<_SIZE, _ALLOC>::mul_acc(r, a.get_ptr(), a.dig(), &b, 1, a.sgn);
+}
+
+template<int _SIZE, class _ALLOC>
+BigInt_t<_SIZE, _ALLOC> & submul(BigInt_t<_SIZE, _ALLOC> & r, const BigInt_t<_SIZE, _ALLOC> & a, typename BigInt_t<_SIZE, _ALLOC>::bui b) {
+	if (a.isNull() || b == 0)
+		return r;
+	if (&r == &a) {
+		BigInt_t<_SIZE, _ALLOC> t(r);
+		return submul(r, t, b);
+	}
+	return BigInt_t<_SIZE, _ALLOC>::mul_acc(r, a.get_ptr(), a.dig(), &b, 1, -a.sgn);
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div(const BigInt_t<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & Q, BigInt_t<SIZE, ALLOC> & R) const
 {
 	if (d.isNull()) {
 		throw BigIntDivideByZeroException();
@@ -1103,44 +2708,25 @@ void BigInt_t<SIZE>::div(const BigInt_t<SIZE> & d, BigInt_t<SIZE> & Q, BigInt_t<
 	Q = 0;
 	auto B = d.abs();
 
-	if (R.compareAbs(B) != -1) {
+	if (B.dig() == 1) {
+		Q = std::move(R);
+		R = BigInt_t<SIZE, ALLOC>(Q.divmod_limb(B[0]), 1);
+	}
+	else if (R.compareAbs(B) != -1) {
 		int bits_shift = SOI - BigIntUtility::_log2(B.data.back()) - 1;
 		R <<= bits_shift;
 		B <<= bits_shift;
-		lui eldest_dig = B.data.back();
-
-		int k = (int)R.dig(), l = (int)B.dig();
-		Q.data.resize(k - l + 1);
-		R.data.reserve(k + 1);
-
-		BigInt_t<SIZE> BS;
-		BS.data.reserve(l + 1);
-		
-		for (int i = k - l; i >= 0; --i) {
-			R.data.resize(i + l + 1, 0);
-			lui temp = ( (lui(R[i + l]) << SOI) | R[i + l - 1] ) / eldest_dig;
-			bui temp_b = bui(temp > C_MAX_DIG ? C_MAX_DIG : temp);
-			R.normalize();
-
-			BS.data = B.data;
-			BS.sgn = 1;
-			BS *= temp_b;
-			subAbs(R, BS, i);
-
-			while (R.isNeg())
-			{
-				subAbs(R, B, i);
-				R.negate();
-				--temp_b;
-			}
-			Q[i] = temp_b;
-		}
+
+		div_abs(R, B, Q);
 		R >>= bits_shift;
-		//R.data.shrink_to_fit();
-		Q.sgn = 1;
 	}
 
-	if (sgn * d.sgn == -1) {
+	div_signs(sgn, d, Q, R);
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_signs(char sa, const BigInt_t<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & Q, BigInt_t<SIZE, ALLOC> & R) {
+	if (sa * d.sgn == -1) {
 		Q.negate();
 		if (!R.isNull()) {
 			--Q;
@@ -1156,35 +2742,685 @@ void BigInt_t<SIZE>::div(const BigInt_t<SIZE> & d, BigInt_t<SIZE> & Q, BigInt_t<
 	R.normalize();
 }
 
-template<int SIZE>
-typename BigInt_t<SIZE>::QuRem BigInt_t<SIZE>::divmod(const BigInt_t<SIZE> & a, const BigInt_t<SIZE> & b)
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_abs(BigInt_t<SIZE, ALLOC> & R, const BigInt_t<SIZE, ALLOC> & B, BigInt_t<SIZE, ALLOC> & Q) {
+	size_t l = B.dig();
+	if (R.dig() < l) {
+		Q = 0;
+		return;
+	}
+	size_t n = std::min(l, R.dig() - l + 1);
+	if (n >= DIV_NEWTON_LIMIT)
+		div_newton(R, B, Q);
+	else if (n >= DIV_BZ_LIMIT)
+		div_bz(R, B, Q);
+	else
+		div_school(R, B, Q, reciprocal_top(B));
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_school(BigInt_t<SIZE, ALLOC> & R, const BigInt_t<SIZE, ALLOC> & B, BigInt_t<SIZE, ALLOC> & Q, bui v) {
+	size_t k = R.dig(), l = B.dig();
+	Q.data.assign(k - l + 1, 0);
+	Q.sgn = 1;
+	if (l == 1) {
+		R = BigInt_t<SIZE, ALLOC>(div_1(Q.get_ptr(), R.get_ptr(), k, B[0]), 1);
+	}
+	else {
+		div_school_n(Q.get_ptr(), R.get_ptr(), k, B.get_ptr(), l, v);
+		R.data.resize(l);
+		R.normalize();
+	}
+	Q.normalize();
+}
+
+//Knuth's algorithm D. The quotient limb is estimated from the three highest limbs of the
+//current remainder and the two highest limbs of d, so it is at most 1 too big.
+//The subtraction of qh * d is fused into the remainder limbs and needs one add-back at most
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_school_n(buip q, buip r, size_t k, buicp d, size_t l, bui v) {
+	bui d1 = d[l - 1], d0 = d[l - 2];
+	q[k - l] = 0;
+	if (cmp_n(r + k - l, d, l) >= 0) {
+		sub_n(r + k - l, r + k - l, d, l);
+		q[k - l] = 1;
+	}
+
+	for (size_t i = k - l; i-- > 0;) {
+		buip ri = r + i;
+		bui n2 = ri[l], n1 = ri[l - 1], n0 = ri[l - 2], qh;
+		if (n2 == d1 && n1 == d0) {
+			//the estimate is B - 1 and it is exact
+			qh = bui(C_MAX_DIG);
+			submul_1(ri, d, l, qh);
+		}
+		else {
+			bui r1, r0;
+			qh = div_3by2_preinv(n2, n1, n0, d1, d0, v, r1, r0);
+			bui borrow = submul_1(ri, d, l - 2, qh);
+			bui b0 = r0 < borrow;
+			ri[l - 2] = bui(r0 - borrow);
+			ri[l - 1] = bui(r1 - b0);
+			if (r1 < b0) {
+				--qh;
+				add_n(ri, ri, d, l);
+			}
+		}
+		ri[l] = 0;
+		q[i] = qh;
+	}
+}
+
+//Newton iteration x = y + y * (B^(2m) - d * y) / B^(2m) starting from the reciprocal
+//of the h highest limbs of d. One guard limb (2h > m) keeps the error from growing
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::reciprocal(const BigInt_t<SIZE, ALLOC> & d) {
+	size_t m = d.dig();
+	if (m < DIV_NEWTON_LIMIT || m < 4) {
+		//not by div_abs, which would come back here for a small DIV_NEWTON_LIMIT
+		BigInt_t<SIZE, ALLOC> r(1), q;
+		r.big_shift(2 * m);
+		if (m + 1 >= DIV_BZ_LIMIT)
+			div_bz(r, d, q);
+		else
+			div_school(r, d, q, reciprocal_top(d));
+		return q;
+	}
+
+	size_t h = m / 2 + 1;
+	BigInt_t<SIZE, ALLOC> y(d);
+	y.big_shift(-(long long)(m - h));
+	y = reciprocal(y);
+
+	//with y' = y * B^(m - h): B^(2m) - d * y' = e * B^(m - h), the correction y' * e * B^(m - h) / B^(2m).
+	//|e| < B^(m + 1) while d y has m + h limbs, so e is found modulo B^N - 1, N >= m + 2, as B^(m + h) + ~(d y).
+	//As 2h > m the limbs of e below B^(m - h - 2) change the correction by less than a unit, the rest is multiplied by y
+	intvec w;
+	size_t N = mult_wrap(w, m + 2, d.get_ptr(), m, y.get_ptr(), y.dig());
+	for (auto & v : w)
+		v = bui(~v);
+	size_t s = (m + h) % N;
+	for (bui c = add_1(w.data() + s, w.data() + s, N - s, 1); c;)
+		c = add_1(w.data(), w.data(), N, c);
+	BigInt_t<SIZE, ALLOC> e = from_wrap(w);
+	long long t = (long long)(m - h) - 2;
+	if (t > 0) {
+		e.big_shift(-t);
+		e.normalize();
+	}
+	else
+		t = 0;
+	e *= y;
+	e.big_shift(t - 2 * (long long)h);
+	e.normalize();
+
+	y.big_shift(m - h);
+	return y += e;
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_barrett(BigInt_t<SIZE, ALLOC> & R, const BigInt_t<SIZE, ALLOC> & D, const BigInt_t<SIZE, ALLOC> & X, BigInt_t<SIZE, ALLOC> & Q) {
+	size_t m = D.dig();
+	Q = R;
+	Q.big_shift(-(long long)(m - 1));
+	Q.normalize();
+	Q *= X;
+	Q.big_shift(-(long long)(m + 1));
+	Q.normalize();
+
+	//R - D Q is less than a few D, so it is found modulo B^N - 1, N >= m + 2, as R + ~(D Q)
+	if (Q.dig() && Q.dig() <= m + 2 && R.dig() <= 2 * m) {
+		intvec w;
+		size_t N = mult_wrap(w, m + 2, D.get_ptr(), m, Q.get_ptr(), Q.dig());
+		for (auto & v : w)
+			v = bui(~v);
+		for (size_t i = 0; i < R.dig(); i += N)
+			add_wrap(w.data(), N, R.get_ptr() + i, std::min(N, R.dig() - i));
+		R = from_wrap(w);
+	}
+	else
+		submul(R, D, Q);
+	while (R.isNeg()) {
+		R += D;
+		--Q;
+	}
+	while (R >= D) {
+		R -= D;
+		++Q;
+	}
+}
+
+//the quotient of n + 1 limbs depends only on the n + 2 highest limbs of the divisor up to a unit.
+//A dividend longer than twice the divisor is divided by pieces of m limbs like in the long division
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_newton(BigInt_t<SIZE, ALLOC> & R, const BigInt_t<SIZE, ALLOC> & D, BigInt_t<SIZE, ALLOC> & Q) {
+	size_t k = R.dig(), m = D.dig(), n = k - m;
+
+	if (m > n + 2) {
+		long long s = (long long)(m - n - 2);
+		BigInt_t<SIZE, ALLOC> r(R), d(D);
+		r.big_shift(-s);
+		d.big_shift(-s);
+		div_barrett(r, d, reciprocal(d), Q);
+
+		submul(R, D, Q);
+		while (R.isNeg()) {
+			R += D;
+			--Q;
+		}
+		while (R >= D) {
+			R -= D;
+			++Q;
+		}
+		return;
+	}
+
+	div_barrett_blocks(R, D, reciprocal(D), Q);
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_barrett_blocks(BigInt_t<SIZE, ALLOC> & R, const BigInt_t<SIZE, ALLOC> & D, const BigInt_t<SIZE, ALLOC> & X, BigInt_t<SIZE, ALLOC> & Q) {
+	size_t k = R.dig(), m = D.dig();
+	if (k <= 2 * m) {
+		div_barrett(R, D, X, Q);
+		return;
+	}
+
+	BigInt_t<SIZE, ALLOC> A(R), q;
+	size_t pieces = (k + m - 1) / m;
+	Q.data.assign(pieces * m, 0);
+	R = 0;
+	for (size_t i = pieces; i-- > 0;) {
+		shift_add(R, piece(A.get_ptr(), A.get_ptr() + k, i, m), m);
+		div_barrett(R, D, X, q);
+		std::copy(q.data.begin(), q.data.end(), Q.data.begin() + i * m);
+	}
+	Q.sgn = 1;
+	Q.normalize();
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::shift_add(BigInt_t<SIZE, ALLOC> & hi, const BigInt_t<SIZE, ALLOC> & lo, size_t h) {
+	limbvec d(lo.data);
+	d.resize(h, 0);
+	d.insert(d.end(), hi.data.begin(), hi.data.end());
+	hi.data = std::move(d);
+	hi.sgn = 1;
+	return hi.normalize();
+}
+
+//the divisor is padded with zero limbs to n = j * 2^t limbs, j < DIV_BZ_LIMIT, so that
+//all the halves are even down to the long division. Then the dividend is divided by pieces of n limbs
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_bz(BigInt_t<SIZE, ALLOC> & R, const BigInt_t<SIZE, ALLOC> & D, BigInt_t<SIZE, ALLOC> & Q) {
+	size_t m = D.dig(), t = 0;
+	while (((m - 1) >> t) + 1 >= DIV_BZ_LIMIT)
+		++t;
+	size_t n = (((m - 1) >> t) + 1) << t, s = n - m;
+
+	BigInt_t<SIZE, ALLOC> A(R), d(D), q;
+	A.big_shift(s);
+	d.big_shift(s);
+	size_t k = A.dig(), pieces = (k + n - 1) / n;
+	Q.data.assign(pieces * n, 0);
+	R = 0;
+	for (size_t i = pieces; i-- > 0;) {
+		shift_add(R, piece(A.get_ptr(), A.get_ptr() + k, i, n), n);
+		div_2by1(R, d, n, q);
+		std::copy(q.data.begin(), q.data.end(), Q.data.begin() + i * n);
+	}
+	Q.sgn = 1;
+	Q.normalize();
+	R.big_shift(-(long long)s);
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_2by1(BigInt_t<SIZE, ALLOC> & R, const BigInt_t<SIZE, ALLOC> & D, size_t n, BigInt_t<SIZE, ALLOC> & Q) {
+	if (n % 2 || n < DIV_BZ_LIMIT) {
+		if (R.dig() < D.dig())
+			Q = 0;
+		else
+			div_school(R, D, Q, reciprocal_top(D));
+		return;
+	}
+
+	size_t h = n / 2;
+	BigInt_t<SIZE, ALLOC> a4 = piece(R.get_ptr(), R.get_ptr() + R.dig(), 0, h), q1;
+	R.big_shift(-(long long)h);
+	R.normalize();
+	div_3by2(R, D, h, q1);
+	shift_add(R, a4, h);
+	div_3by2(R, D, h, Q);
+	shift_add(q1, Q, h);
+	Q = std::move(q1);
+}
+
+//the quotient of the top 2h limbs by the top h limbs of d is at most 2 more than the true one
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div_3by2(BigInt_t<SIZE, ALLOC> & R, const BigInt_t<SIZE, ALLOC> & D, size_t h, BigInt_t<SIZE, ALLOC> & Q) {
+	BigInt_t<SIZE, ALLOC> b1(D), b2 = piece(D.get_ptr(), D.get_ptr() + D.dig(), 0, h);
+	BigInt_t<SIZE, ALLOC> a3 = piece(R.get_ptr(), R.get_ptr() + R.dig(), 0, h);
+	b1.big_shift(-(long long)h);
+	R.big_shift(-(long long)h);
+	R.normalize();
+
+	if (R.compareAbs(b1, h) < 0) {
+		div_2by1(R, b1, h, Q);
+	}
+	else {
+		//Q = B^h - 1, R = R - Q * b1
+		Q = 1;
+		Q.big_shift(h);
+		--Q;
+		subAbs(R, b1, h);
+		addAbs(R, b1);
+	}
+	shift_add(R, a3, h);
+	submul(R, b2, Q);
+	while (R.isNeg()) {
+		R += D;
+		--Q;
+	}
+}
+
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::QuRem BigInt_t<SIZE, ALLOC>::divmod(const BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b)
 {
-	BigInt_t<SIZE> Q, R;
+	BigInt_t<SIZE, ALLOC> Q, R;
 	a.div(b, Q, R);
 	return QuRem(Q, R);
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator / (const BigInt_t<SIZE> & d) const {
-	BigInt_t<SIZE> Q, R;
+//the trailing zero bits of d are removed from both numbers, then d is odd and the quotient
+//is found modulo B^k from the lowest limbs: q[i] = a[i] / d[0] mod B, a -= q[i] * d * B^i.
+//Only the lowest k limbs of a are needed, k is the length of the quotient
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::divexact(const BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & d) {
+	if (d.isNull()) {
+		throw BigIntDivideByZeroException();
+	}
+	if (a.isNull()) {
+		return BigInt_t<SIZE, ALLOC>();
+	}
+
+	BigInt_t<SIZE, ALLOC> Q = a.abs();
+	if (d.dig() == 1) {
+		div_exact_1(Q, d[0]);
+		if (a.sgn * d.sgn < 0)
+			Q.negate();
+		return Q;
+	}
+
+	size_t z = 0;
+	while (!d[z])
+		++z;
+	long long shift = (long long)(z * SOI + BigIntUtility::_log2(bui(d[z] & bui(~d[z] + 1))));
+	BigInt_t<SIZE, ALLOC> D = d.abs();
+	if (shift) {
+		Q >>= shift;
+		D >>= shift;
+	}
+
+	size_t m = D.dig();
+	if (Q.dig() < m) {
+		return BigInt_t<SIZE, ALLOC>();
+	}
+	size_t k = Q.dig() - m + 1;
+	if (m == 1) {
+		div_exact_1(Q, D[0]);
+	}
+	else if (std::min(k, m) >= DIVEXACT_LIMIT) {
+		Q /= D;
+	}
+	else {
+		Q.data.resize(k);
+		bui inv = inverse_1(D[0]);
+		for (size_t i = 0; i < k; ++i) {
+			bui q = bui(Q[i] * inv);
+			size_t j = i + std::min(m, k - i);
+			bui borrow = submul_1(&Q[i], D.get_ptr(), j - i, q);
+			for (; j < k && borrow; ++j) {
+				bui o = Q[j];
+				Q[j] = bui(o - borrow);
+				borrow = o < borrow;
+			}
+			Q[i] = q;
+		}
+		Q.normalize();
+	}
+
+	if (a.sgn * d.sgn < 0)
+		Q.negate();
+	return Q;
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator / (const BigInt_t<SIZE, ALLOC> & d) const {
+	BigInt_t<SIZE, ALLOC> Q, R;
 	div(d, Q, R);
 	return Q;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> BigInt_t<SIZE>::operator % (const BigInt_t<SIZE> & d) const {
-	BigInt_t<SIZE> Q, R;
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator % (const BigInt_t<SIZE, ALLOC> & d) const {
+	BigInt_t<SIZE, ALLOC> Q, R;
 	div(d, Q, R);
 	return R;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator /= (const BigInt_t<SIZE> & a) {
+template<int SIZE, class ALLOC>
+typename BigInt_t<SIZE, ALLOC>::bui BigInt_t<SIZE, ALLOC>::divmod_limb(bui d) {
+	if (!d) {
+		throw BigIntDivideByZeroException();
+	}
+	bui r = div_1(get_ptr(), get_ptr(), dig(), d);
+	normalize();
+	return r;
+}
+
+template<int SIZE, class ALLOC>
+void BigInt_t<SIZE, ALLOC>::div(const BigIntDivisor<SIZE, ALLOC> & d, BigInt_t<SIZE, ALLOC> & Q, BigInt_t<SIZE, ALLOC> & R) const {
+	d.div(*this, Q, R);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator / (const BigIntDivisor<SIZE, ALLOC> & d) const {
+	return d.div(*this);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::operator % (const BigIntDivisor<SIZE, ALLOC> & d) const {
+	return d.mod(*this);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigInt_t<SIZE, ALLOC>::powmod(const BigInt_t<SIZE, ALLOC> & base, const BigInt_t<SIZE, ALLOC> & exp, const BigInt_t<SIZE, ALLOC> & mod) {
+	if (mod.isOdd())
+		return BigIntMontgomery<SIZE, ALLOC>(mod).pow(base, exp);
+
+	if (exp.isNeg()) {
+		throw BigIntNegativeExponentException();
+	}
+	BigIntDivisor<SIZE, ALLOC> D(mod.abs());
+	if (exp.isNull())
+		return BigInt_t<SIZE, ALLOC>(1) % D;
+
+	//the window of BigIntMontgomery::pow. Products go to t and are reduced there by D, then t and
+	//the accumulator swap, so that the limbs of t, the quotient q and the scratch ws are reused
+	size_t bits = exp.bit_length();
+	size_t w = bits > 670 ? 6 : bits > 240 ? 5 : bits > 80 ? 4 : bits > 24 ? 3 : bits > 6 ? 2 : 1;
+	auto bit = [&exp](size_t i) {
+		return (exp[i / SOI] >> (i % SOI)) & 1;
+	};
+	BigInt_t<SIZE, ALLOC> t, q, x;
+	intvec ws;
+	// a = a * b mod D, a square if a and b are the same object
+	auto mulmod = [&](BigInt_t<SIZE, ALLOC> & a, const BigInt_t<SIZE, ALLOC> & b) {
+		if (a.isNull() || b.isNull()) {
+			a = 0;
+			return;
+		}
+		size_t k = a.dig(), l = b.dig();
+		t.data.resize(k + l);
+		if (std::min(k, l) < TOOM3_LIMIT) {
+			ws.resize(kara_scratch(std::max(k, l)));
+			if (&a == &b)
+				kara_sqr(t.get_ptr(), a.get_ptr(), k, ws.data());
+			else if (k >= l)
+				kara_mul(t.get_ptr(), a.get_ptr(), k, b.get_ptr(), l, ws.data());
+			else
+				kara_mul(t.get_ptr(), b.get_ptr(), l, a.get_ptr(), k, ws.data());
+		}
+		else
+			mult_to(t.get_ptr(), a.get_ptr(), a.get_ptr() + k, b.get_ptr(), b.get_ptr() + l);
+		t.sgn = 1;
+		t.normalize();
+		D.reduce(t, q);
+		std::swap(a, t);
+	};
+
+	std::vector<BigInt_t<SIZE, ALLOC>> table((size_t)1 << (w - 1));
+	table[0] = base % D;
+	if (w > 1) {
+		x = table[0];
+		mulmod(x, x);
+		for (size_t k = 1; k < table.size(); ++k) {
+			table[k] = table[k - 1];
+			mulmod(table[k], x);
+		}
+	}
+
+	bool first = true;
+	for (size_t i = bits; i-- > 0;) {
+		if (!bit(i)) {
+			mulmod(x, x);
+			continue;
+		}
+		size_t j = i + 1 > w ? i + 1 - w : 0, v = 0;
+		while (!bit(j))
+			++j;
+		for (size_t k = i + 1; k-- > j;) {
+			v = 2 * v + bit(k);
+			if (!first)
+				mulmod(x, x);
+		}
+		if (first)
+			x = table[v >> 1];
+		else
+			mulmod(x, table[v >> 1]);
+		first = false;
+		i = j;
+	}
+	return x;
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator /= (const BigInt_t<SIZE, ALLOC> & a) {
 	return *this = *this / a;
 }
 
-template<int SIZE>
-BigInt_t<SIZE> & BigInt_t<SIZE>::operator %= (const BigInt_t<SIZE> & a) {
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> & BigInt_t<SIZE, ALLOC>::operator %= (const BigInt_t<SIZE, ALLOC> & a) {
 	return *this = *this % a;
 }
 
+template<int SIZE, class ALLOC>
+BigIntDivisor<SIZE, ALLOC>::BigIntDivisor(const BI & d) : d(d), norm(d.abs()) {
+	if (d.isNull()) {
+		throw BigIntDivideByZeroException();
+	}
+	shift = BI::SOI - BigIntUtility::_log2(norm.data.back()) - 1;
+	norm <<= shift;
+	v = BI::reciprocal_top(norm);
+	if (norm.dig() >= BI::DIV_BZ_LIMIT)
+		x = BI::reciprocal(norm);
+}
+
+template<int SIZE, class ALLOC>
+void BigIntDivisor<SIZE, ALLOC>::div(const BI & a, BI & Q, BI & R) const {
+	char sa = a.sgn;
+	R = a.abs();
+	Q = 0;
+
+	if (norm.dig() == 1) {
+		Q = std::move(R);
+		R = BI(BI::div_1_preinv(Q.get_ptr(), Q.get_ptr(), Q.dig(), norm[0], v, shift), 1);
+	}
+	else if (R.compareAbs(d) != -1) {
+		R <<= shift;
+		if (x.isNull())
+			BI::div_school(R, norm, Q, v);
+		else
+			BI::div_barrett_blocks(R, norm, x, Q);
+		R >>= shift;
+	}
+
+	BI::div_signs(sa, d, Q, R);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigIntDivisor<SIZE, ALLOC>::div(const BI & a) const {
+	BI Q, R;
+	div(a, Q, R);
+	return Q;
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigIntDivisor<SIZE, ALLOC>::mod(const BI & a) const {
+	BI Q, R;
+	div(a, Q, R);
+	return R;
+}
+
+template<int SIZE, class ALLOC>
+void BigIntDivisor<SIZE, ALLOC>::reduce(BI & a, BI & q) const {
+	a.sgn = a.isNull() ? 0 : 1;
+	if (norm.dig() == 1) {
+		bui r = BI::div_1_preinv(a.get_ptr(), a.get_ptr(), a.dig(), norm[0], v, shift);
+		a.data.assign(1, r);
+		a.sgn = 1;
+	}
+	else if (a.compareAbs(d) != -1) {
+		a <<= shift;
+		if (x.isNull())
+			BI::div_school(a, norm, q, v);
+		else
+			BI::div_barrett_blocks(a, norm, x, q);
+		a >>= shift;
+	}
+	a.normalize();
+}
+
+template<int SIZE, class ALLOC>
+BigIntMontgomery<SIZE, ALLOC>::BigIntMontgomery(const BI & m) : m(m.abs()), n(m.dig()) {
+	if (m.isNull()) {
+		throw BigIntDivideByZeroException();
+	}
+	if (m.isEven()) {
+		throw BigIntEvenModulusException();
+	}
+	minv = bui(0 - BI::inverse_1(m[0]));
+	r2 = 1;
+	r2.big_shift(2 * n);
+	r2 %= this->m;
+}
+
+template<int SIZE, class ALLOC>
+size_t BigIntMontgomery<SIZE, ALLOC>::scratch_size() const {
+	return 2 * n + BI::kara_scratch(n);
+}
+
+template<int SIZE, class ALLOC>
+void BigIntMontgomery<SIZE, ALLOC>::load(buip r, const BI & a) const {
+	std::copy(a.data.begin(), a.data.end(), r);
+	std::fill(r + a.dig(), r + n, bui(0));
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigIntMontgomery<SIZE, ALLOC>::store(buicp a) const {
+	BI res;
+	res.data.assign(a, a + n);
+	res.sgn = 1;
+	return res.normalize();
+}
+
+//t[i] becomes zero after the addition of u * m * B^i, so the carry out of that row
+//is kept there and added to the high half at the end
+template<int SIZE, class ALLOC>
+void BigIntMontgomery<SIZE, ALLOC>::redc(buip r, buip t) const {
+	buicp mp = m.get_ptr();
+	for (size_t i = 0; i < n; ++i) {
+		bui u = bui(t[i] * minv);
+		t[i] = BI::addmul_1(t + i, mp, n, u);
+	}
+	//the sum is below 2m
+	if (BI::add_n(r, t + n, t, n) || BI::cmp_n(r, mp, n) >= 0)
+		BI::sub_n(r, r, mp, n);
+}
+
+template<int SIZE, class ALLOC>
+void BigIntMontgomery<SIZE, ALLOC>::mul(buip r, buicp a, buicp b, buip ws) const {
+	BI::kara_mul(ws, a, n, b, n, ws + 2 * n);
+	redc(r, ws);
+}
+
+template<int SIZE, class ALLOC>
+void BigIntMontgomery<SIZE, ALLOC>::sqr(buip r, buicp a, buip ws) const {
+	BI::kara_sqr(ws, a, n, ws + 2 * n);
+	redc(r, ws);
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigIntMontgomery<SIZE, ALLOC>::to_mont(const BI & a) const {
+	typename BI::intvec x(n), y(n), ws(scratch_size());
+	load(x.data(), a % m);
+	load(y.data(), r2);
+	mul(x.data(), x.data(), y.data(), ws.data());
+	return store(x.data());
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigIntMontgomery<SIZE, ALLOC>::from_mont(const BI & a) const {
+	typename BI::intvec t(2 * n);
+	load(t.data(), a);
+	redc(t.data(), t.data());
+	return store(t.data());
+}
+
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigIntMontgomery<SIZE, ALLOC>::mul(const BI & a, const BI & b) const {
+	typename BI::intvec x(n), y(n), ws(scratch_size());
+	load(x.data(), a);
+	load(y.data(), b);
+	mul(x.data(), x.data(), y.data(), ws.data());
+	return store(x.data());
+}
+
+//the table holds the odd powers a, a^3, ..., a^(2^w - 1). The exponent is scanned from the top
+//by windows of at most w bits which start and end with 1, zero bits between them are squarings
+template<int SIZE, class ALLOC>
+BigInt_t<SIZE, ALLOC> BigIntMontgomery<SIZE, ALLOC>::pow(const BI & a, const BI & e) const {
+	if (e.isNeg()) {
+		throw BigIntNegativeExponentException();
+	}
+	if (e.isNull())
+		return BI(1) % m;
+
+	size_t bits = (e.dig() - 1) * BI::SOI + BigIntUtility::_log2(e.data.back()) + 1;
+	size_t w = bits > 670 ? 6 : bits > 240 ? 5 : bits > 80 ? 4 : bits > 24 ? 3 : bits > 6 ? 2 : 1;
+	auto bit = [&e](size_t i) {
+		return (e[i / BI::SOI] >> (i % BI::SOI)) & 1;
+	};
+
+	typename BI::intvec table(n << (w - 1)), acc(n), ws(scratch_size());
+	buip g = table.data(), x = acc.data();
+	load(g, to_mont(a));
+	if (w > 1) {
+		sqr(x, g, ws.data());
+		for (size_t k = 1; k < ((size_t)1 << (w - 1)); ++k)
+			mul(g + k * n, g + (k - 1) * n, x, ws.data());
+	}
+
+	bool first = true;
+	for (size_t i = bits; i-- > 0;) {
+		if (!bit(i)) {
+			sqr(x, x, ws.data());
+			continue;
+		}
+		size_t j = i + 1 > w ? i + 1 - w : 0, v = 0;
+		while (!bit(j))
+			++j;
+		for (size_t k = i + 1; k-- > j;) {
+			v = 2 * v + bit(k);
+			if (!first)
+				sqr(x, x, ws.data());
+		}
+		if (first)
+			std::copy(g + (v >> 1) * n, g + (v >> 1) * n + n, x);
+		else
+			mul(x, x, g + (v >> 1) * n, ws.data());
+		first = false;
+		i = j;
+	}
+	return from_mont(store(x));
+}
@@ -0,0 +1,234 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+//Allocators of limbs, the second template parameter of BigInt_t. An allocator is a class with
+//	static void * allocate(size_t bytes);
+//	static void deallocate(void * p, size_t bytes);	bytes are the ones given to allocate
+//	static const bool SCOPED;	true if its memory is valid only in some scope of one thread,
+//								then BigInt_t doesn't multiply such numbers by other threads
+//Numbers with different allocators are different types, they are converted by explicit constructors
+namespace BigIntUtility {
+
+	//the global operator new
+	struct HeapAllocator {
+		static const bool SCOPED = false;
+
+		static void * allocate(size_t bytes) {
+			return ::operator new(bytes);
+		}
+		static void deallocate(void * p, size_t) {
+			::operator delete(p);
+		}
+	};
+
+	//Pool of free blocks of each thread. Sizes are rounded up to powers of two from 2^MIN_CLASS
+	//to 2^MAX_CLASS bytes, up to CACHED_BLOCKS free blocks of each size are kept by a thread
+	//and given again without the heap and its locks. Larger blocks are taken from the heap.
+	//Blocks may be freed by any thread, the cache of a thread is freed at its exit
+	class PoolAllocator {
+	public:
+		static const bool SCOPED = false;
+		static const unsigned MIN_CLASS = 6;
+		static const unsigned MAX_CLASS = 16;
+		static const unsigned CACHED_BLOCKS = 64;
+
+		static void * allocate(size_t bytes) {
+			unsigned c = size_class(bytes);
+			if (c > MAX_CLASS)
+				return ::operator new(bytes);
+			FreeList & f = cache().lists[c - MIN_CLASS];
+			if (f.head) {
+				void * p = f.head;
+				f.head = *(void **)p;
+				--f.count;
+				return p;
+			}
+			return ::operator new(size_t(1) << c);
+		}
+
+		static void deallocate(void * p, size_t bytes) {
+			unsigned c = size_class(bytes);
+			Cache & k = cache();
+			if (c > MAX_CLASS || k.closed || k.lists[c - MIN_CLASS].count == CACHED_BLOCKS) {
+				::operator delete(p);
+				return;
+			}
+			drain_at_exit();
+			FreeList & f = k.lists[c - MIN_CLASS];
+			*(void **)p = f.head;
+			f.head = p;
+			++f.count;
+		}
+
+		//returns the free blocks of this thread to the heap
+		static void trim() {
+			Cache & k = cache();
+			for (auto & f : k.lists) {
+				while (f.head) {
+					void * p = f.head;
+					f.head = *(void **)p;
+					::operator delete(p);
+				}
+				f.count = 0;
+			}
+		}
+
+	private:
+		struct FreeList {
+			void * head;
+			unsigned count;
+		};
+		//has no constructor and destructor, so it may be used by destructors of other thread_local objects
+		struct Cache {
+			FreeList lists[MAX_CLASS - MIN_CLASS + 1];
+			bool closed;
+		};
+		struct Drain {
+			~Drain() {
+				trim();
+				cache().closed = true;
+			}
+		};
+
+		static Cache & cache() {
+			thread_local Cache k;
+			return k;
+		}
+		static void drain_at_exit() {
+			thread_local Drain d;
+			(void)d;
+		}
+		//the least c >= MIN_CLASS with 2^c >= bytes
+		static unsigned size_class(size_t bytes) {
+			unsigned c = MIN_CLASS;
+			while ((size_t(1) << c) < bytes)
+				++c;
+			return c;
+		}
+	};
+
+	//Bump-pointer arena of each thread. Memory is taken from the heap in chunks of CHUNK bytes
+	//and given in order, a block is freed only if it is the last given one. Everything given
+	//in a Scope is freed at once at its end, so numbers with this allocator should be destroyed
+	//or converted to another allocator before the end of the scope in which they are created.
+	//They must not be passed to other threads.
+	//	{
+	//		BigIntUtility::ArenaAllocator::Scope scope;
+	//		SquareMatrix<BigInt_t<64, BigIntUtility::ArenaAllocator>> m(n);
+	//		...
+	//		auto inv = m.inverse();
+	//		res = BigInt(inv[0][0]);
+	//	}
+	class ArenaAllocator {
+		struct Chunk {
+			Chunk * prev;
+			char * end;
+		};
+
+	public:
+		static const bool SCOPED = true;
+		static const size_t CHUNK = size_t(1) << 20;
+		//count of freed chunks kept by a thread for next scopes
+		static const unsigned SPARE_CHUNKS = 16;
+		static const size_t ALIGN = alignof(std::max_align_t);
+
+		static void * allocate(size_t bytes) {
+			bytes = round(bytes);
+			State & s = state();
+			if (!s.chunk || size_t(s.chunk->end - s.top) < bytes)
+				new_chunk(bytes);
+			void * p = s.top;
+			s.top += bytes;
+			return p;
+		}
+
+		static void deallocate(void * p, size_t bytes) {
+			State & s = state();
+			if ((char *)p + round(bytes) == s.top)
+				s.top = (char *)p;
+		}
+
+		//frees the memory given by the arena of this thread since the construction of the scope
+		class Scope {
+			Chunk * chunk;
+			char * top;
+		public:
+			Scope() : chunk(state().chunk), top(state().top) {}
+			Scope(const Scope &) = delete;
+			Scope & operator=(const Scope &) = delete;
+			~Scope() {
+				release(chunk, top);
+			}
+		};
+
+	private:
+		//has no constructor and destructor, so it may be used by destructors of other thread_local objects
+		struct State {
+			Chunk * chunk;
+			char * top;
+			//freed chunks of CHUNK bytes
+			Chunk * spare;
+			unsigned spares;
+		};
+		struct Drain {
+			~Drain() {
+				State & s = state();
+				release(nullptr, nullptr);
+				while (s.spare) {
+					Chunk * c = s.spare;
+					s.spare = c->prev;
+					::operator delete(c);
+				}
+				s.spares = 0;
+			}
+		};
+
+		static State & state() {
+			thread_local State s;
+			return s;
+		}
+		static size_t round(size_t bytes) {
+			return (bytes + ALIGN - 1) / ALIGN * ALIGN;
+		}
+		static size_t header() {
+			return round(sizeof(Chunk));
+		}
+
+		static void new_chunk(size_t bytes) {
+			thread_local Drain d;
+			(void)d;
+			State & s = state();
+			size_t size = bytes + header() > CHUNK ? bytes + header() : CHUNK;
+			char * mem;
+			if (size == CHUNK && s.spare) {
+				mem = (char *)s.spare;
+				s.spare = s.spare->prev;
+				--s.spares;
+			}
+			else
+				mem = (char *)::operator new(size);
+			Chunk * c = (Chunk *)mem;
+			c->prev = s.chunk;
+			c->end = mem + size;
+			s.chunk = c;
+			s.top = mem + header();
+		}
+
+		static void release(Chunk * chunk, char * top) {
+			State & s = state();
+			while (s.chunk != chunk) {
+				Chunk * c = s.chunk;
+				s.chunk = c->prev;
+				if (s.spares < SPARE_CHUNKS && size_t(c->end - (char *)c) == CHUNK) {
+					c->prev = s.spare;
+					s.spare = c;
+					++s.spares;
+				}
+				else
+					::operator delete(c);
+			}
+			s.top = top;
+		}
+	};
+}
@@ -0,0 +1,355 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <istream>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_WIN32)
+	#if !defined(NOMINMAX)
+		#define NOMINMAX
+	#endif
+	#if !defined(WIN32_LEAN_AND_MEAN)
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include "BigInt.h"
+
+//Binary files of BigInt_t numbers, all fields are little-endian:
+//	header of 24 bytes: "BIGINTB" and a zero byte, uint32 bits of a limb, uint32 0, uint64 count of numbers;
+//	every number: int64 n, then |n| limbs. The sign of n is the sign of the number, zero has no limbs.
+//Numbers are padded with zero bytes to a multiple of 8 bytes, so limbs in a mapped file are aligned.
+//A file written with limbs of one size is read by BigInt_t of any size.
+namespace BigIntUtility {
+
+	const char BINARY_MAGIC[8] = { 'B', 'I', 'G', 'I', 'N', 'T', 'B', 0 };
+	const size_t BINARY_HEADER = 24;
+
+	inline bool little_endian() {
+		const uint16_t one = 1;
+		return *(const unsigned char *)&one == 1;
+	}
+
+	template<typename T>
+	T load_le(const unsigned char * p) {
+		typename std::make_unsigned<T>::type r = 0;
+		for (size_t i = sizeof(T); i-- > 0;)
+			r = (r << 8) | p[i];
+		return T(r);
+	}
+
+	template<typename T>
+	void store_le(unsigned char * p, T v) {
+		typename std::make_unsigned<T>::type u = v;
+		for (size_t i = 0; i < sizeof(T); ++i, u >>= 8)
+			p[i] = (unsigned char)u;
+	}
+
+	//read-only mapping of a whole file to memory
+	class MappedFile {
+		const unsigned char * ptr = nullptr;
+		size_t len = 0;
+#if defined(_WIN32)
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = NULL;
+#endif
+
+		void unmap() {
+#if defined(_WIN32)
+			if (ptr)
+				UnmapViewOfFile(ptr);
+			if (mapping)
+				CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+#else
+			if (ptr)
+				munmap((void *)ptr, len);
+#endif
+		}
+
+	public:
+		explicit MappedFile(const std::string & path) {
+#if defined(_WIN32)
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			LARGE_INTEGER sz;
+			if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &sz)) {
+				unmap();
+				throw BigIntFileException();
+			}
+			len = (size_t)sz.QuadPart;
+			if (len) {
+				mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+				ptr = mapping ? (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+				if (!ptr) {
+					unmap();
+					throw BigIntFileException();
+				}
+			}
+#else
+			int fd = open(path.c_str(), O_RDONLY);
+			struct stat st;
+			if (fd < 0 || fstat(fd, &st) != 0) {
+				if (fd >= 0)
+					close(fd);
+				throw BigIntFileException();
+			}
+			len = (size_t)st.st_size;
+			if (len) {
+				void * p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (p == MAP_FAILED) {
+					close(fd);
+					throw BigIntFileException();
+				}
+				ptr = (const unsigned char *)p;
+			}
+			//the mapping stays valid without the descriptor
+			close(fd);
+#endif
+		}
+		MappedFile(const MappedFile &) = delete;
+		MappedFile & operator=(const MappedFile &) = delete;
+		~MappedFile() {
+			unmap();
+		}
+
+		const unsigned char * data() const {
+			return ptr;
+		}
+		size_t size() const {
+			return len;
+		}
+	};
+}
+
+//Read-only view of a number in a mapped file, valid while its BigIntReader exists
+template<int SIZE>
+class BigIntView {
+public:
+	typedef BigInt_t<SIZE> BI;
+	typedef typename BI::buicp buicp;
+
+	BigIntView(char sgn, buicp p, size_t n) : sgn(sgn), p(p), n(n) {}
+
+	char signum() const {
+		return sgn;
+	}
+	//count of limbs and the limbs from the lowest one
+	size_t dig() const {
+		return n;
+	}
+	buicp limbs() const {
+		return p;
+	}
+
+private:
+	char sgn;
+	buicp p;
+	size_t n;
+};
+
+//Reader of a binary file. The file is mapped to memory and indexed once, a number
+//is constructed by one memcpy of its limbs or viewed without copying
+template<int SIZE>
+class BigIntReader {
+public:
+	typedef BigInt_t<SIZE> BI;
+	typedef typename BI::bui bui;
+
+	explicit BigIntReader(const std::string & path);
+
+	//count of numbers in the file
+	size_t size() const {
+		return offsets.size();
+	}
+	//size of limbs in the file in bits
+	unsigned limb_bits() const {
+		return bits;
+	}
+
+	//i-th number of the file
+	BI operator[](size_t i) const;
+	//i-th number in place, the file should have limbs of SIZE bits on a little-endian machine
+	BigIntView<SIZE> view(size_t i) const;
+
+private:
+	BigIntUtility::MappedFile file;
+	unsigned bits;
+	//offsets of the numbers in the file
+	std::vector<size_t> offsets;
+
+	int64_t record(size_t i) const {
+		return BigIntUtility::load_le<int64_t>(file.data() + offsets[i]);
+	}
+};
+
+//Writer of a binary file with limbs of SIZE bits. The count of numbers in the header
+//is written by close(), which is called by the destructor too
+template<int SIZE>
+class BigIntWriter {
+public:
+	typedef BigInt_t<SIZE> BI;
+	typedef typename BI::bui bui;
+
+	explicit BigIntWriter(const std::string & path);
+	BigIntWriter(const BigIntWriter &) = delete;
+	BigIntWriter & operator=(const BigIntWriter &) = delete;
+	~BigIntWriter();
+
+	void write(const BI & a);
+	BigIntWriter & operator<<(const BI & a) {
+		write(a);
+		return *this;
+	}
+	//converts a text corpus: writes all the whitespace separated numbers of text
+	//which are read by operator>>. Returns their count
+	size_t write_text(std::istream & text);
+	void close();
+
+	//count of numbers written
+	size_t size() const {
+		return count;
+	}
+
+private:
+	std::ofstream f;
+	size_t count = 0;
+};
+
+template<int SIZE>
+BigIntReader<SIZE>::BigIntReader(const std::string & path) : file(path) {
+	const unsigned char * p = file.data();
+	size_t len = file.size();
+	if (len < BigIntUtility::BINARY_HEADER || memcmp(p, BigIntUtility::BINARY_MAGIC, 8) != 0) {
+		throw BigIntFormatException();
+	}
+	bits = BigIntUtility::load_le<uint32_t>(p + 8);
+	uint64_t cnt = BigIntUtility::load_le<uint64_t>(p + 16);
+	if ((bits != 8 && bits != 16 && bits != 32 && bits != 64) || cnt > (len - BigIntUtility::BINARY_HEADER) / 8) {
+		throw BigIntFormatException();
+	}
+
+	offsets.resize((size_t)cnt);
+	size_t pos = BigIntUtility::BINARY_HEADER;
+	for (auto & off : offsets) {
+		if (len - pos < 8)
+			throw BigIntFormatException();
+		off = pos;
+		int64_t n = BigIntUtility::load_le<int64_t>(p + pos);
+		if (n == INT64_MIN || uint64_t(n < 0 ? -n : n) > (len - pos - 8) / (bits / 8))
+			throw BigIntFormatException();
+		uint64_t bytes = uint64_t(n < 0 ? -n : n) * (bits / 8);
+		pos += 8 + (size_t)((bytes + 7) / 8 * 8);
+		if (pos > len)
+			throw BigIntFormatException();
+	}
+}
+
+template<int SIZE>
+BigInt_t<SIZE> BigIntReader<SIZE>::operator[](size_t i) const {
+	int64_t n = record(i);
+	const unsigned char * p = file.data() + offsets[i] + 8;
+	size_t bytes = size_t(n < 0 ? -n : n) * (bits / 8);
+
+	//the limbs of the file make the same little-endian string of bytes for any size of limbs
+	BI res;
+	res.data.resize((bytes + sizeof(bui) - 1) / sizeof(bui));
+	if (BigIntUtility::little_endian()) {
+		if (bytes)
+			memcpy(res.data.data(), p, bytes);
+	}
+	else {
+		for (size_t b = 0; b < bytes; ++b)
+			res.data[b / sizeof(bui)] |= bui(bui(p[b]) << (8 * (b % sizeof(bui))));
+	}
+	res.sgn = n < 0 ? -1 : 1;
+	return res.normalize();
+}
+
+template<int SIZE>
+BigIntView<SIZE> BigIntReader<SIZE>::view(size_t i) const {
+	if (bits != SIZE || !BigIntUtility::little_endian()) {
+		throw BigIntFormatException();
+	}
+	int64_t n = record(i);
+	return BigIntView<SIZE>(n < 0 ? -1 : (n > 0 ? 1 : 0),
+		(typename BI::buicp)(file.data() + offsets[i] + 8), size_t(n < 0 ? -n : n));
+}
+
+template<int SIZE>
+BigIntWriter<SIZE>::BigIntWriter(const std::string & path) : f(path, std::ios::binary) {
+	unsigned char header[BigIntUtility::BINARY_HEADER] = {};
+	memcpy(header, BigIntUtility::BINARY_MAGIC, 8);
+	BigIntUtility::store_le<uint32_t>(header + 8, SIZE);
+	f.write((const char *)header, sizeof(header));
+	if (!f) {
+		throw BigIntFileException();
+	}
+}
+
+template<int SIZE>
+BigIntWriter<SIZE>::~BigIntWriter() {
+	try {
+		close();
+	}
+	catch (...) {
+	}
+}
+
+template<int SIZE>
+void BigIntWriter<SIZE>::write(const BI & a) {
+	unsigned char n[8];
+	BigIntUtility::store_le<int64_t>(n, int64_t(a.dig()) * a.signum());
+	f.write((const char *)n, 8);
+
+	size_t bytes = a.dig() * sizeof(bui);
+	if (BigIntUtility::little_endian()) {
+		f.write((const char *)a.get_ptr(), bytes);
+	}
+	else {
+		for (size_t i = 0; i < a.dig(); ++i) {
+			unsigned char limb[sizeof(bui)];
+			BigIntUtility::store_le<bui>(limb, a[i]);
+			f.write((const char *)limb, sizeof(bui));
+		}
+	}
+	const char pad[8] = {};
+	f.write(pad, (8 - bytes % 8) % 8);
+	if (!f) {
+		throw BigIntFileException();
+	}
+	++count;
+}
+
+template<int SIZE>
+size_t BigIntWriter<SIZE>::write_text(std::istream & text) {
+	size_t n = 0;
+	BI a;
+	while (text >> a) {
+		write(a);
+		++n;
+	}
+	return n;
+}
+
+template<int SIZE>
+void BigIntWriter<SIZE>::close() {
+	if (!f.is_open())
+		return;
+	unsigned char cnt[8];
+	BigIntUtility::store_le<uint64_t>(cnt, count);
+	f.seekp(16);
+	f.write((const char *)cnt, 8);
+	f.close();
+	if (!f) {
+		throw BigIntFileException();
+	}
+}
@@ -17,4 +17,28 @@ class BigIntIllegalDigitException : public BigIntException {
 	const char * what() const noexcept {
 		return "Big Integer: Unknown digit in input/output";
 	}
+};
+
+class BigIntNegativeExponentException : public BigIntException {
+	const char * what() const noexcept {
+		return "Big Integer: Negative exponent";
+	}
+};
+
+class BigIntEvenModulusException : public BigIntException {
+	const char * what() const noexcept {
+		return "Big Integer: Montgomery form needs an odd modulus";
+	}
+};
+
+class BigIntFileException : public BigIntException {
+	const char * what() const noexcept {
+		return "Big Integer: Unable to open, map or write a file";
+	}
+};
+
+class BigIntFormatException : public BigIntException {
+	const char * what() const noexcept {
+		return "Big Integer: Wrong format of a binary file";
+	}
 };
\ No newline at end of file
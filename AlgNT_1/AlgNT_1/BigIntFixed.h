@@ -0,0 +1,382 @@
+#pragma once
+#include <array>
+#include <type_traits>
+#include <string>
+#include <iostream>
+
+#include "BigInt.h"
+
+//true during constant evaluation, where the arithmetic can't leave constexpr code.
+//Without the builtin it is always true and only the constexpr code is used
+#if defined(__cpp_lib_is_constant_evaluated)
+#define __BIGINT_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) && __GNUC__ >= 9 || defined(__clang__) && __clang_major__ >= 9 || defined(_MSC_VER) && _MSC_VER >= 1925
+#define __BIGINT_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define __BIGINT_CONSTANT_EVALUATED() true
+#endif
+
+namespace BigIntUtility {
+
+	//calls f(i) for i = I, ..., N - 1. The recursion is expanded at compile time, so the loop is unrolled.
+	//The range is split in halves, so the depth of instantiation is log2(N - I), not N - I
+	template<size_t I, size_t N, size_t L = N - I>
+	struct Unroll {
+		template<class F>
+		static constexpr void run(F & f) {
+			Unroll<I, I + L / 2>::run(f);
+			Unroll<I + L / 2, N>::run(f);
+		}
+	};
+	template<size_t I, size_t N>
+	struct Unroll<I, N, 1> {
+		template<class F>
+		static constexpr void run(F & f) {
+			f(I);
+		}
+	};
+	template<size_t I, size_t N>
+	struct Unroll<I, N, 0> {
+		template<class F>
+		static constexpr void run(F &) {}
+	};
+}
+
+//Unsigned integer of BITS bits in limbs of SIZE bits, the arithmetic is modulo 2^BITS.
+//The limbs are kept in std::array: there are no allocations, sign and normalization,
+//loops over limbs are unrolled at compile time. For operands of bounded size, e.g. 256 to 4096 bits.
+//All the arithmetic is constexpr, in constant expressions since C++17 (std::array is constexpr there)
+template<unsigned BITS, int SIZE>
+class FixedBigInt {
+	static_assert(
+		SIZE == 8 || SIZE == 16 || SIZE == 32 || SIZE == 64,
+		"Size of primitive should be 8, 16, 32 or 64");
+	static_assert(BITS > 0 && BITS % SIZE == 0, "Count of bits should be a multiple of the size of primitive");
+public:
+	typedef typename BigIntUtility::uint_t<SIZE>::type		bui;
+	typedef typename BigIntUtility::uint_t<SIZE * 2>::type	lui;
+
+	//count of limbs
+	static const size_t N = BITS / SIZE;
+	static const unsigned char SOI = SIZE;
+
+	constexpr FixedBigInt() : d{} {}
+	//val mod 2^BITS
+	constexpr FixedBigInt(unsigned long long val) : d{} {
+		for (size_t i = 0; i < N && val != 0; ++i) {
+			d[i] = bui(val);
+			//in two steps, SIZE may be 64
+			val >>= SIZE / 2;
+			val >>= SIZE / 2;
+		}
+	}
+	//a mod 2^BITS, negative numbers in two's complement
+	template<int _SIZE, class _ALLOC>
+	explicit FixedBigInt(const BigInt_t<_SIZE, _ALLOC> & a);
+	explicit FixedBigInt(const std::string & s) : FixedBigInt(BigInt_t<SIZE>(s)) {}
+
+	//the same number, 0 <= res < 2^BITS
+	template<int _SIZE = SIZE, class _ALLOC = BigIntUtility::HeapAllocator>
+	BigInt_t<_SIZE, _ALLOC> to_BigInt() const;
+	std::string to_string() const {
+		return to_BigInt().to_string();
+	}
+
+	//i-th limb from the lowest one
+	constexpr bui operator[](size_t i) const {
+		return d[i];
+	}
+	constexpr bool bit(size_t i) const {
+		return (d[i / SIZE] >> (i % SIZE)) & 1;
+	}
+	constexpr bool isNull() const {
+		bool r = true;
+		auto f = [&](size_t i) { r = r && d[i] == 0; };
+		BigIntUtility::Unroll<0, N>::run(f);
+		return r;
+	}
+	constexpr explicit operator bool() const {
+		return !isNull();
+	}
+
+	//-1, 0, 1 if this is less than, equal to, greater than b
+	constexpr int compare(const FixedBigInt & b) const;
+
+	constexpr FixedBigInt & operator += (const FixedBigInt & b);
+	constexpr FixedBigInt & operator -= (const FixedBigInt & b);
+	constexpr FixedBigInt & operator *= (const FixedBigInt & b);
+	constexpr FixedBigInt & operator &= (const FixedBigInt & b);
+	constexpr FixedBigInt & operator |= (const FixedBigInt & b);
+	constexpr FixedBigInt & operator ^= (const FixedBigInt & b);
+	constexpr FixedBigInt & operator <<= (unsigned n);
+	constexpr FixedBigInt & operator >>= (unsigned n);
+	constexpr FixedBigInt & operator ++ () {
+		return *this += FixedBigInt(1);
+	}
+	constexpr FixedBigInt & operator -- () {
+		return *this -= FixedBigInt(1);
+	}
+	constexpr FixedBigInt operator ~ () const;
+	constexpr FixedBigInt operator - () const {
+		return ++~*this;
+	}
+
+	//the whole product of 2 BITS bits
+	constexpr FixedBigInt<2 * BITS, SIZE> mul_full(const FixedBigInt & b) const;
+
+	friend constexpr FixedBigInt operator + (FixedBigInt a, const FixedBigInt & b) {
+		return a += b;
+	}
+	friend constexpr FixedBigInt operator - (FixedBigInt a, const FixedBigInt & b) {
+		return a -= b;
+	}
+	friend constexpr FixedBigInt operator * (FixedBigInt a, const FixedBigInt & b) {
+		return a *= b;
+	}
+	friend constexpr FixedBigInt operator & (FixedBigInt a, const FixedBigInt & b) {
+		return a &= b;
+	}
+	friend constexpr FixedBigInt operator | (FixedBigInt a, const FixedBigInt & b) {
+		return a |= b;
+	}
+	friend constexpr FixedBigInt operator ^ (FixedBigInt a, const FixedBigInt & b) {
+		return a ^= b;
+	}
+	friend constexpr FixedBigInt operator << (FixedBigInt a, unsigned n) {
+		return a <<= n;
+	}
+	friend constexpr FixedBigInt operator >> (FixedBigInt a, unsigned n) {
+		return a >>= n;
+	}
+
+	friend constexpr bool operator == (const FixedBigInt & a, const FixedBigInt & b) {
+		bool r = true;
+		auto f = [&](size_t i) { r = r && a.d[i] == b.d[i]; };
+		BigIntUtility::Unroll<0, N>::run(f);
+		return r;
+	}
+	friend constexpr bool operator != (const FixedBigInt & a, const FixedBigInt & b) {
+		return !(a == b);
+	}
+	friend constexpr bool operator < (const FixedBigInt & a, const FixedBigInt & b) {
+		return a.compare(b) < 0;
+	}
+	friend constexpr bool operator > (const FixedBigInt & a, const FixedBigInt & b) {
+		return a.compare(b) > 0;
+	}
+	friend constexpr bool operator <= (const FixedBigInt & a, const FixedBigInt & b) {
+		return a.compare(b) <= 0;
+	}
+	friend constexpr bool operator >= (const FixedBigInt & a, const FixedBigInt & b) {
+		return a.compare(b) >= 0;
+	}
+
+	friend std::ostream & operator << (std::ostream & s, const FixedBigInt & a) {
+		return s << a.to_BigInt();
+	}
+	friend std::istream & operator >> (std::istream & s, FixedBigInt & a) {
+		BigInt_t<SIZE> t;
+		if (s >> t)
+			a = FixedBigInt(t);
+		return s;
+	}
+
+	template<unsigned _BITS, int _SIZE> friend class FixedBigInt;
+
+private:
+	std::array<bui, N> d;
+
+	//r[0, 2N) = a * b by BigInt_t Karatsuba with the scratch on the stack, for N from KARATSUBA_LIMIT
+	static void kara_full(bui * r, const FixedBigInt & a, const FixedBigInt & b);
+	//a = a * b by kara_full
+	static void kara_low(FixedBigInt & a, const FixedBigInt & b);
+};
+
+template<unsigned BITS, int SIZE>
+template<int _SIZE, class _ALLOC>
+FixedBigInt<BITS, SIZE>::FixedBigInt(const BigInt_t<_SIZE, _ALLOC> & a) : d{} {
+	//pieces of the width of the shorter limb
+	const unsigned w = SIZE < _SIZE ? SIZE : _SIZE;
+	for (size_t bit = 0; bit < BITS && bit < a.dig() * _SIZE; bit += w) {
+		typename BigInt_t<_SIZE, _ALLOC>::bui v = a[bit / _SIZE] >> (bit % _SIZE);
+		d[bit / SIZE] |= bui(bui(v) << (bit % SIZE));
+	}
+	if (a.isNeg())
+		*this = -*this;
+}
+
+template<unsigned BITS, int SIZE>
+template<int _SIZE, class _ALLOC>
+BigInt_t<_SIZE, _ALLOC> FixedBigInt<BITS, SIZE>::to_BigInt() const {
+	typedef BigInt_t<_SIZE, _ALLOC> BI;
+	const unsigned w = SIZE < _SIZE ? SIZE : _SIZE;
+	BI res;
+	res.data.assign((BITS + _SIZE - 1) / _SIZE, 0);
+	for (size_t bit = 0; bit < BITS; bit += w) {
+		bui v = d[bit / SIZE] >> (bit % SIZE);
+		res.data[bit / _SIZE] |= typename BI::bui(typename BI::bui(v) << (bit % _SIZE));
+	}
+	res.sgn = 1;
+	return res.normalize();
+}
+
+template<unsigned BITS, int SIZE>
+constexpr int FixedBigInt<BITS, SIZE>::compare(const FixedBigInt & b) const {
+	int r = 0;
+	auto f = [&](size_t i) {
+		size_t k = N - 1 - i;
+		if (r == 0 && d[k] != b.d[k])
+			r = d[k] < b.d[k] ? -1 : 1;
+	};
+	BigIntUtility::Unroll<0, N>::run(f);
+	return r;
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<BITS, SIZE> & FixedBigInt<BITS, SIZE>::operator += (const FixedBigInt & b) {
+	bui carry = 0;
+	auto f = [&](size_t i) {
+		lui t = (lui)d[i] + b.d[i] + carry;
+		d[i] = bui(t);
+		carry = bui(t >> SIZE);
+	};
+	BigIntUtility::Unroll<0, N>::run(f);
+	return *this;
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<BITS, SIZE> & FixedBigInt<BITS, SIZE>::operator -= (const FixedBigInt & b) {
+	bui borrow = 0;
+	auto f = [&](size_t i) {
+		lui t = (lui)d[i] - b.d[i] - borrow;
+		d[i] = bui(t);
+		borrow = bui(t >> SIZE) & 1;
+	};
+	BigIntUtility::Unroll<0, N>::run(f);
+	return *this;
+}
+
+template<unsigned BITS, int SIZE>
+void FixedBigInt<BITS, SIZE>::kara_full(bui * r, const FixedBigInt & a, const FixedBigInt & b) {
+	typedef BigInt_t<SIZE> BI;
+	//kara_scratch is 4 * ceil(k / 2) limbs per level: less than 4 * (N + levels)
+	bui ws[4 * (N + 64)];
+	if (&a == &b)
+		BI::kara_sqr(r, a.d.data(), N, ws);
+	else
+		BI::kara_mul(r, a.d.data(), N, b.d.data(), N, ws);
+}
+
+template<unsigned BITS, int SIZE>
+void FixedBigInt<BITS, SIZE>::kara_low(FixedBigInt & a, const FixedBigInt & b) {
+	bui r[2 * N];
+	kara_full(r, a, b);
+	std::copy(r, r + N, a.d.begin());
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<BITS, SIZE> & FixedBigInt<BITS, SIZE>::operator *= (const FixedBigInt & b) {
+	if (!__BIGINT_CONSTANT_EVALUATED() && N >= BigInt_t<SIZE>::KARATSUBA_LIMIT) {
+		kara_low(*this, b);
+		return *this;
+	}
+
+	//schoolbook product of the lower N limbs
+	FixedBigInt r;
+	auto row = [&](size_t i) {
+		bui carry = 0;
+		for (size_t j = 0; j + i < N; ++j) {
+			lui t = (lui)d[i] * b.d[j] + r.d[i + j] + carry;
+			r.d[i + j] = bui(t);
+			carry = bui(t >> SIZE);
+		}
+	};
+	BigIntUtility::Unroll<0, N>::run(row);
+	return *this = r;
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<2 * BITS, SIZE> FixedBigInt<BITS, SIZE>::mul_full(const FixedBigInt & b) const {
+	FixedBigInt<2 * BITS, SIZE> r;
+	if (!__BIGINT_CONSTANT_EVALUATED() && N >= BigInt_t<SIZE>::KARATSUBA_LIMIT) {
+		kara_full(r.d.data(), *this, b);
+		return r;
+	}
+
+	auto row = [&](size_t i) {
+		bui carry = 0;
+		for (size_t j = 0; j < N; ++j) {
+			lui t = (lui)d[i] * b.d[j] + r.d[i + j] + carry;
+			r.d[i + j] = bui(t);
+			carry = bui(t >> SIZE);
+		}
+		r.d[i + N] = carry;
+	};
+	BigIntUtility::Unroll<0, N>::run(row);
+	return r;
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<BITS, SIZE> & FixedBigInt<BITS, SIZE>::operator &= (const FixedBigInt & b) {
+	auto f = [&](size_t i) { d[i] &= b.d[i]; };
+	BigIntUtility::Unroll<0, N>::run(f);
+	return *this;
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<BITS, SIZE> & FixedBigInt<BITS, SIZE>::operator |= (const FixedBigInt & b) {
+	auto f = [&](size_t i) { d[i] |= b.d[i]; };
+	BigIntUtility::Unroll<0, N>::run(f);
+	return *this;
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<BITS, SIZE> & FixedBigInt<BITS, SIZE>::operator ^= (const FixedBigInt & b) {
+	auto f = [&](size_t i) { d[i] ^= b.d[i]; };
+	BigIntUtility::Unroll<0, N>::run(f);
+	return *this;
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<BITS, SIZE> FixedBigInt<BITS, SIZE>::operator ~ () const {
+	FixedBigInt r;
+	auto f = [&](size_t i) { r.d[i] = bui(~d[i]); };
+	BigIntUtility::Unroll<0, N>::run(f);
+	return r;
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<BITS, SIZE> & FixedBigInt<BITS, SIZE>::operator <<= (unsigned n) {
+	size_t q = n / SIZE;
+	unsigned s = n % SIZE;
+	//from the highest limb, so that the limbs are read before they are changed
+	auto f = [&](size_t i) {
+		size_t k = N - 1 - i;
+		bui v = 0;
+		if (k >= q) {
+			v = bui(d[k - q] << s);
+			if (s != 0 && k > q)
+				v |= bui(d[k - q - 1] >> (SIZE - s));
+		}
+		d[k] = v;
+	};
+	BigIntUtility::Unroll<0, N>::run(f);
+	return *this;
+}
+
+template<unsigned BITS, int SIZE>
+constexpr FixedBigInt<BITS, SIZE> & FixedBigInt<BITS, SIZE>::operator >>= (unsigned n) {
+	size_t q = n / SIZE;
+	unsigned s = n % SIZE;
+	auto f = [&](size_t k) {
+		bui v = 0;
+		if (k + q < N) {
+			v = bui(d[k + q] >> s);
+			if (s != 0 && k + q + 1 < N)
+				v |= bui(d[k + q + 1] << (SIZE - s));
+		}
+		d[k] = v;
+	};
+	BigIntUtility::Unroll<0, N>::run(f);
+	return *this;
+}
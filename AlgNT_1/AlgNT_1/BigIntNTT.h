@@ -0,0 +1,388 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "BigIntThreads.h"
+
+//Number-theoretic transform multiplication of limb arrays.
+//The product is computed modulo three primes p < 2^31 with 2^24 | p - 1
+//and restored by Chinese remainder theorem (Garner's scheme).
+//Operands are cut into 32-bit digits (or 16-bit ones for the longest transforms),
+//so a convolution term is less than 2^21 * 2^64 (or 2^24 * 2^32)
+//and fits into p0 * p1 * p2 > 2^85. Only 32x32->64 bit multiplications are used.
+//In parallel mode the primes, the butterflies of every stage and the CRT are shared by the threads of thread_pool().
+namespace BigIntUtility {
+
+	//Montgomery arithmetic modulo odd prime p < 2^31, R = 2^32
+	class NTTPrime {
+		uint32_t p;
+		//-p^(-1) mod 2^32
+		uint32_t pinv;
+		//2^64 mod p
+		uint32_t r2;
+		//primitive root modulo p
+		uint32_t g;
+
+	public:
+		NTTPrime(uint32_t p, uint32_t g) : p(p), g(g) {
+			uint32_t inv = p;
+			for (int i = 0; i < 4; ++i) {
+				inv *= 2 - p * inv;
+			}
+			pinv = 0u - inv;
+			r2 = uint32_t((uint64_t(1) << 63) % p * 2 % p);
+		}
+
+		uint32_t mod() const {
+			return p;
+		}
+
+		// T * 2^(-32) mod p, T < p * 2^32
+		inline uint32_t reduce(uint64_t T) const {
+			uint32_t m = uint32_t(T) * pinv;
+			uint32_t t = uint32_t((T + uint64_t(m) * p) >> 32);
+			return t >= p ? t - p : t;
+		}
+		// a * b * 2^(-32) mod p
+		inline uint32_t mul(uint32_t a, uint32_t b) const {
+			return reduce(uint64_t(a) * b);
+		}
+		inline uint32_t add(uint32_t a, uint32_t b) const {
+			uint32_t s = a + b;
+			return s >= p ? s - p : s;
+		}
+		inline uint32_t sub(uint32_t a, uint32_t b) const {
+			return a >= b ? a - b : a + p - b;
+		}
+		//x * 2^32 mod p
+		inline uint32_t to_mont(uint32_t x) const {
+			return mul(x, r2);
+		}
+		//x^n, x and result are in Montgomery form
+		uint32_t pow(uint32_t x, uint64_t n) const {
+			uint32_t res = to_mont(1);
+			while (n) {
+				if (n & 1)
+					res = mul(res, x);
+				x = mul(x, x);
+				n >>= 1;
+			}
+			return res;
+		}
+		//x^(-1), x and result are in Montgomery form
+		uint32_t inv(uint32_t x) const {
+			return pow(x, p - 2);
+		}
+
+		//roots[i] = w^i for i < n/2, w is a primitive n-th root of unity (or its inverse). Montgomery form
+		void roots(std::vector<uint32_t> & r, size_t n, bool inverse) const {
+			uint32_t w = pow(to_mont(g), (p - 1) / n);
+			if (inverse)
+				w = inv(w);
+			r.resize(std::max<size_t>(n / 2, 1));
+			r[0] = to_mont(1);
+			for (size_t i = 1; i < r.size(); ++i) {
+				r[i] = mul(r[i - 1], w);
+			}
+		}
+
+		//calls f(b, e) for [0, n) or for its parts in parallel
+		static void for_range(size_t n, bool parallel, const std::function<void(size_t, size_t)> & f) {
+			if (parallel)
+				thread_pool().parallel_for(n, f);
+			else
+				f(0, n);
+		}
+
+		//decimation in frequency, natural order in, bit-reversed order out
+		void forward(uint32_t * a, size_t n, const std::vector<uint32_t> & r, bool parallel = false) const {
+			const uint32_t * w = r.data();
+			for (size_t len = n, step = 1; len >= 2; len >>= 1, step <<= 1) {
+				size_t h = len >> 1;
+				//butterflies t in [tb, te) of this stage, t = i * h + j for the block i.
+				//The local copy of the modulus can't be aliased by a
+				for_range(n >> 1, parallel, [=](size_t tb, size_t te) {
+					const NTTPrime P = *this;
+					size_t j = tb % h, i = (tb - j) << 1;
+					for (size_t t = tb; t < te; ++t) {
+						uint32_t u = a[i + j], v = a[i + j + h];
+						a[i + j] = P.add(u, v);
+						a[i + j + h] = P.mul(P.sub(u, v), w[j * step]);
+						if (++j == h) {
+							j = 0;
+							i += len;
+						}
+					}
+				});
+			}
+		}
+
+		//decimation in time, bit-reversed order in, natural order out. Not scaled by 1/n
+		void backward(uint32_t * a, size_t n, const std::vector<uint32_t> & r, bool parallel = false) const {
+			const uint32_t * w = r.data();
+			for (size_t len = 2, step = n >> 1; len <= n; len <<= 1, step >>= 1) {
+				size_t h = len >> 1;
+				for_range(n >> 1, parallel, [=](size_t tb, size_t te) {
+					const NTTPrime P = *this;
+					size_t j = tb % h, i = (tb - j) << 1;
+					for (size_t t = tb; t < te; ++t) {
+						uint32_t u = a[i + j], v = P.mul(a[i + j + h], w[j * step]);
+						a[i + j] = P.add(u, v);
+						a[i + j + h] = P.sub(u, v);
+						if (++j == h) {
+							j = 0;
+							i += len;
+						}
+					}
+				});
+			}
+		}
+
+		//res[0..n) = cyclic convolution of fa and fb modulo p. fb is destroyed.
+		//If square is set fb is not used and fa is convolved with itself
+		void convolution(const std::vector<uint32_t> & fa, std::vector<uint32_t> & fb, std::vector<uint32_t> & res, size_t n, bool square = false, bool parallel = false) const {
+			std::vector<uint32_t> r;
+			res.resize(n);
+			for (size_t i = 0; i < n; ++i) {
+				res[i] = i < fa.size() ? fa[i] % p : 0;
+			}
+			roots(r, n, false);
+			forward(res.data(), n, r, parallel);
+			if (square) {
+				for (size_t i = 0; i < n; ++i) {
+					res[i] = mul(res[i], res[i]);
+				}
+			}
+			else {
+				for (auto & x : fb) {
+					x %= p;
+				}
+				fb.resize(n, 0);
+				forward(fb.data(), n, r, parallel);
+				//a * b / R, the missing factor R is restored on scaling
+				for (size_t i = 0; i < n; ++i) {
+					res[i] = mul(res[i], fb[i]);
+				}
+			}
+
+			roots(r, n, true);
+			backward(res.data(), n, r, parallel);
+			// R / n in Montgomery form
+			uint32_t scale = to_mont(inv(to_mont(uint32_t(n % p))));
+			for (size_t i = 0; i < n; ++i) {
+				res[i] = mul(res[i], scale);
+			}
+		}
+	};
+
+	//maximal transform length: 2^24 divides p - 1 for all the primes
+	const size_t NTT_MAX_LENGTH = size_t(1) << 24;
+	//maximal transform length for 32-bit digits: 2^21 * 2^64 < p0 * p1 * p2
+	const size_t NTT_MAX_LENGTH_32 = size_t(1) << 21;
+
+	//128-bit accumulator for CRT restoring
+	struct NTTAccumulator {
+		uint64_t lo, hi;
+
+		NTTAccumulator() : lo(0), hi(0) {}
+		inline void add(uint64_t l, uint64_t h) {
+			lo += l;
+			hi += h + (lo < l);
+		}
+		// returns lower w bits and shifts the accumulator right by w
+		inline uint32_t pop(unsigned w) {
+			uint32_t d = uint32_t(lo & ((uint64_t(1) << w) - 1));
+			lo = (lo >> w) | (hi << (64 - w));
+			hi >>= w;
+			return d;
+		}
+	};
+
+	//i-th w-bit digit of the number [a, a + n), w = 16 or 32
+	template<typename T>
+	inline uint32_t ntt_digit(const T * a, size_t n, size_t i, unsigned w) {
+		const unsigned bits = sizeof(T) * 8;
+		if (bits >= w) {
+			const size_t per = bits / w;
+			return uint32_t((a[i / per] >> (w * (i % per))) & ((uint64_t(1) << w) - 1));
+		}
+		const size_t cnt = w / bits;
+		uint32_t d = 0;
+		for (size_t j = 0; j < cnt && i * cnt + j < n; ++j) {
+			d |= uint32_t(a[i * cnt + j]) << (bits * j);
+		}
+		return d;
+	}
+
+	//r[0, n) |= d, the i-th w-bit digit of r. r is zero-filled before
+	template<typename T>
+	inline void ntt_set_digit(T * r, size_t n, size_t i, unsigned w, uint32_t d) {
+		const unsigned bits = sizeof(T) * 8;
+		if (bits >= w) {
+			const size_t per = bits / w;
+			r[i / per] |= T(d) << (w * (i % per));
+			return;
+		}
+		const size_t cnt = w / bits;
+		for (size_t j = 0; j < cnt && i * cnt + j < n; ++j) {
+			r[i * cnt + j] = T(d >> (bits * j));
+		}
+	}
+
+	//number of w-bit digits in the number of n limbs
+	template<typename T>
+	inline size_t ntt_digits(size_t n, unsigned w) {
+		return (n * sizeof(T) * 8 + w - 1) / w;
+	}
+
+	//transform length for the product of k-limb and l-limb numbers with w-bit digits
+	template<typename T>
+	inline size_t ntt_length(size_t k, size_t l, unsigned w) {
+		size_t n = 1;
+		while (n < ntt_digits<T>(k, w) + ntt_digits<T>(l, w) - 1)
+			n <<= 1;
+		return n;
+	}
+
+	//checks if the product of k-limb and l-limb numbers may be computed by ntt_mult
+	template<typename T>
+	inline bool ntt_fits(size_t k, size_t l) {
+		return ntt_length<T>(k, l, 16) <= NTT_MAX_LENGTH;
+	}
+
+	//the primes of the transforms
+	inline const NTTPrime * ntt_primes() {
+		static const NTTPrime P[3] = {
+			NTTPrime(167772161, 3),
+			NTTPrime(469762049, 3),
+			NTTPrime(754974721, 11) };
+		return P;
+	}
+
+	//cyclic convolution of length n of the w-bit digits of a[0, k) and b[0, l) modulo the three primes.
+	//The first count coefficients are turned into the mixed radix digits r0, t1, t2 of r0 + p0 t1 + p0 p1 t2 by Garner's scheme
+	template<typename T>
+	void ntt_convolution(std::vector<uint32_t>(&res)[3], const T * a, size_t k, const T * b, size_t l, size_t n, unsigned w, size_t count, bool parallel) {
+		const NTTPrime * P = ntt_primes();
+		size_t da = ntt_digits<T>(k, w), db = ntt_digits<T>(l, w);
+
+		bool square = a == b && k == l;
+		std::vector<uint32_t> fa(da), fb[3];
+		for (size_t i = 0; i < da; ++i)
+			fa[i] = ntt_digit(a, k, i, w);
+		std::vector<std::function<void()>> primes;
+		for (int j = 0; j < 3; ++j) {
+			primes.push_back([&, j]() {
+				if (!square) {
+					fb[j].resize(db);
+					for (size_t i = 0; i < db; ++i)
+						fb[j][i] = ntt_digit(b, l, i, w);
+				}
+				P[j].convolution(fa, fb[j], res[j], n, square, parallel);
+			});
+		}
+		if (parallel)
+			thread_pool().run(primes);
+		else
+			for (auto & f : primes)
+				f();
+
+		//Garner's constants in Montgomery form: p0^(-1) mod p1, (p0 p1)^(-1) mod p2, p0 mod p2
+		const uint32_t p0 = P[0].mod(), p1 = P[1].mod();
+		const uint64_t p01 = uint64_t(p0) * p1;
+		const uint32_t inv0 = P[1].inv(P[1].to_mont(p0));
+		const uint32_t inv01 = P[2].inv(P[2].to_mont(uint32_t(p01 % P[2].mod())));
+		const uint32_t p0_2 = P[2].to_mont(p0);
+
+		//mixed radix digits t1, t2 replace res[1], res[2]
+		NTTPrime::for_range(std::min(count, n), parallel, [&](size_t ib, size_t ie) {
+			for (size_t i = ib; i < ie; ++i) {
+				uint32_t r0 = res[0][i];
+				uint32_t t1 = P[1].mul(P[1].sub(res[1][i], r0), inv0);
+				uint32_t y = P[2].add(r0, P[2].mul(t1, p0_2));
+				res[1][i] = t1;
+				res[2][i] = P[2].mul(P[2].sub(res[2][i], y), inv01);
+			}
+		});
+	}
+
+	//acc += the i-th coefficient of the convolution restored by ntt_convolution
+	inline void ntt_add_coefficient(NTTAccumulator & acc, const std::vector<uint32_t>(&res)[3], size_t i) {
+		const NTTPrime * P = ntt_primes();
+		const uint32_t p0 = P[0].mod();
+		const uint64_t p01 = uint64_t(p0) * P[1].mod();
+		uint32_t r0 = res[0][i], t1 = res[1][i], t2 = res[2][i];
+		uint64_t lt = (p01 & 0xFFFFFFFF) * t2, ht = (p01 >> 32) * t2;
+		acc.add(uint64_t(r0) + uint64_t(p0) * t1, 0);
+		acc.add(lt, 0);
+		acc.add(ht << 32, ht >> 32);
+	}
+
+	//r[0, k + l) = a[0, k) * b[0, l). The same operands are squared with two transforms instead of three
+	template<typename T>
+	void ntt_mult(T * r, const T * a, size_t k, const T * b, size_t l, bool parallel = false) {
+		//32-bit digits halve the transform length while the convolution terms fit
+		unsigned w = ntt_length<T>(k, l, 32) <= NTT_MAX_LENGTH_32 ? 32 : 16;
+		size_t n = ntt_length<T>(k, l, w);
+		size_t dr = ntt_digits<T>(k + l, w);
+
+		std::vector<uint32_t> res[3];
+		ntt_convolution(res, a, k, b, l, n, w, dr, parallel);
+
+		std::fill(r, r + k + l, T(0));
+		NTTAccumulator acc;
+		for (size_t i = 0; i < dr; ++i) {
+			if (i < n)
+				ntt_add_coefficient(acc, res, i);
+			ntt_set_digit(r, k + l, i, w, acc.pop(w));
+		}
+	}
+
+	//length N >= m of the products of ntt_mult_wrap: a power of two, at least one 32-bit digit
+	template<typename T>
+	inline size_t ntt_wrap_size(size_t m) {
+		size_t N = std::max<size_t>(1, 4 / sizeof(T));
+		while (N < m)
+			N <<= 1;
+		return N;
+	}
+
+	//checks if products modulo B^N - 1 may be computed by ntt_mult_wrap
+	template<typename T>
+	inline bool ntt_wrap_fits(size_t N) {
+		return ntt_digits<T>(N, 16) <= NTT_MAX_LENGTH;
+	}
+
+	//r[0, N) = a[0, k) * b[0, l) mod (B^N - 1), B = 2^(8 sizeof(T)), k, l <= N, N = ntt_wrap_size(N).
+	//B^N = 1 modulo B^N - 1, so the product is the cyclic convolution of the length of N limbs,
+	//half the transform of the whole product. The result may be B^N - 1 for 0
+	template<typename T>
+	void ntt_mult_wrap(T * r, size_t N, const T * a, size_t k, const T * b, size_t l, bool parallel = false) {
+		unsigned w = ntt_digits<T>(N, 32) <= NTT_MAX_LENGTH_32 ? 32 : 16;
+		size_t n = ntt_digits<T>(N, w);
+
+		std::vector<uint32_t> res[3];
+		ntt_convolution(res, a, k, b, l, n, w, n, parallel);
+
+		std::fill(r, r + N, T(0));
+		NTTAccumulator acc;
+		for (size_t i = 0; i < n; ++i) {
+			ntt_add_coefficient(acc, res, i);
+			ntt_set_digit(r, N, i, w, acc.pop(w));
+		}
+		//the carry out of the highest digit is added to the lowest ones
+		const uint32_t mask = uint32_t((uint64_t(1) << w) - 1);
+		for (size_t i = 0; acc.lo || acc.hi; i = (i + 1) % n) {
+			acc.add(ntt_digit(r, N, i, w), 0);
+			uint32_t d = acc.pop(w);
+			if (sizeof(T) * 8 >= w) {
+				const size_t per = sizeof(T) * 8 / w;
+				T & x = r[i / per];
+				x = T((x & ~(T(mask) << (w * (i % per)))) | (T(d) << (w * (i % per))));
+			}
+			else
+				ntt_set_digit(r, N, i, w, d);
+		}
+	}
+}
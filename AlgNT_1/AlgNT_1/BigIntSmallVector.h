@@ -0,0 +1,250 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+#include "BigIntAllocator.h"
+
+//Vector which keeps up to N elements in itself and takes memory from ALLOC (see BigIntAllocator.h)
+//only for more of them.
+//BigInt_t keeps its limbs in it, so small numbers are created, copied and destroyed without allocations.
+//Only trivially copyable elements are allowed: they are moved by memcpy and are not destroyed.
+//Unlike std::vector a move of a vector with inline elements copies them, so pointers
+//to the elements of a moved vector are not valid any more
+namespace BigIntUtility {
+
+	template<typename T, size_t N, class ALLOC = HeapAllocator>
+	class SmallVector {
+		static_assert(std::is_trivially_copyable<T>::value, "SmallVector keeps only trivially copyable types");
+		static_assert(N > 0, "SmallVector should keep at least one element inline");
+
+	public:
+		typedef T				value_type;
+		typedef size_t			size_type;
+		typedef ptrdiff_t		difference_type;
+		typedef T &				reference;
+		typedef const T &		const_reference;
+		typedef T *				pointer;
+		typedef const T *		const_pointer;
+		typedef T *				iterator;
+		typedef const T *		const_iterator;
+
+		//count of elements kept without allocations
+		static const size_t INLINE = N;
+
+		SmallVector() : ptr(buf), len(0), cap(N) {}
+		explicit SmallVector(size_t n, const T & val = T()) : SmallVector() {
+			assign(n, val);
+		}
+		template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+		SmallVector(It first, It last) : SmallVector() {
+			assign(first, last);
+		}
+		SmallVector(const SmallVector & v) : SmallVector() {
+			assign(v.begin(), v.end());
+		}
+		SmallVector(SmallVector && v) noexcept : SmallVector() {
+			take(v);
+		}
+		~SmallVector() {
+			release();
+		}
+
+		//the memory of this vector is reused if the elements of v fit in it
+		SmallVector & operator=(const SmallVector & v) {
+			if (this != &v)
+				assign(v.begin(), v.end());
+			return *this;
+		}
+		SmallVector & operator=(SmallVector && v) noexcept {
+			if (this != &v)
+				take(v);
+			return *this;
+		}
+
+		size_t size() const {
+			return len;
+		}
+		bool empty() const {
+			return len == 0;
+		}
+		size_t capacity() const {
+			return cap;
+		}
+		//whether the elements are kept inline
+		bool is_inline() const {
+			return ptr == buf;
+		}
+
+		T * data() {
+			return ptr;
+		}
+		const T * data() const {
+			return ptr;
+		}
+		iterator begin() {
+			return ptr;
+		}
+		iterator end() {
+			return ptr + len;
+		}
+		const_iterator begin() const {
+			return ptr;
+		}
+		const_iterator end() const {
+			return ptr + len;
+		}
+		T & operator[](size_t i) {
+			return ptr[i];
+		}
+		const T & operator[](size_t i) const {
+			return ptr[i];
+		}
+		T & front() {
+			return ptr[0];
+		}
+		const T & front() const {
+			return ptr[0];
+		}
+		T & back() {
+			return ptr[len - 1];
+		}
+		const T & back() const {
+			return ptr[len - 1];
+		}
+
+		void reserve(size_t n) {
+			if (n > cap)
+				reallocate(n);
+		}
+		void clear() {
+			len = 0;
+		}
+		void resize(size_t n, const T & val = T()) {
+			if (n > len) {
+				grow(n);
+				std::fill(ptr + len, ptr + n, val);
+			}
+			len = n;
+		}
+		void assign(size_t n, const T & val) {
+			len = 0;
+			if (n > cap)
+				reallocate(n);
+			std::fill(ptr, ptr + n, val);
+			len = n;
+		}
+		template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+		void assign(It first, It last) {
+			size_t n = (size_t)std::distance(first, last);
+			len = 0;
+			if (n > cap)
+				reallocate(n);
+			std::copy(first, last, ptr);
+			len = n;
+		}
+		void push_back(const T & val) {
+			if (len == cap) {
+				//val may be an element of this vector
+				T v = val;
+				grow(len + 1);
+				ptr[len++] = v;
+			}
+			else
+				ptr[len++] = val;
+		}
+		void pop_back() {
+			--len;
+		}
+
+		iterator insert(const_iterator pos, size_t n, const T & val) {
+			size_t i = pos - ptr;
+			T v = val;
+			open(i, n);
+			std::fill(ptr + i, ptr + i + n, v);
+			return ptr + i;
+		}
+		//the range should not be a part of this vector
+		template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+		iterator insert(const_iterator pos, It first, It last) {
+			size_t i = pos - ptr;
+			open(i, (size_t)std::distance(first, last));
+			std::copy(first, last, ptr + i);
+			return ptr + i;
+		}
+		iterator insert(const_iterator pos, const T & val) {
+			return insert(pos, 1, val);
+		}
+		iterator erase(const_iterator first, const_iterator last) {
+			size_t i = first - ptr, n = last - first;
+			if (n) {
+				memmove(ptr + i, ptr + i + n, (len - i - n) * sizeof(T));
+				len -= n;
+			}
+			return ptr + i;
+		}
+		iterator erase(const_iterator pos) {
+			return erase(pos, pos + 1);
+		}
+
+		void swap(SmallVector & v) noexcept {
+			SmallVector t(std::move(v));
+			v = std::move(*this);
+			*this = std::move(t);
+		}
+
+	private:
+		T * ptr;
+		size_t len;
+		size_t cap;
+		T buf[N];
+
+		void release() {
+			if (!is_inline())
+				ALLOC::deallocate(ptr, cap * sizeof(T));
+		}
+		//moves the elements to new memory for n elements
+		void reallocate(size_t n) {
+			T * p = static_cast<T *>(ALLOC::allocate(n * sizeof(T)));
+			if (len)
+				memcpy(p, ptr, len * sizeof(T));
+			release();
+			ptr = p;
+			cap = n;
+		}
+		//makes room for n elements, at least doubling the capacity like std::vector
+		void grow(size_t n) {
+			if (n > cap)
+				reallocate(std::max(n, 2 * cap));
+		}
+		//inserts n uninitialized elements at i
+		void open(size_t i, size_t n) {
+			grow(len + n);
+			memmove(ptr + i + n, ptr + i, (len - i) * sizeof(T));
+			len += n;
+		}
+		//takes the elements of v. Its heap memory is taken as is, inline elements are copied
+		void take(SmallVector & v) {
+			if (v.is_inline()) {
+				if (v.len)
+					memcpy(ptr, v.ptr, v.len * sizeof(T));
+				len = v.len;
+			}
+			else {
+				release();
+				ptr = v.ptr;
+				len = v.len;
+				cap = v.cap;
+				v.ptr = v.buf;
+				v.cap = N;
+			}
+			v.len = 0;
+		}
+	};
+
+	template<typename T, size_t N, class ALLOC>
+	const size_t SmallVector<T, N, ALLOC>::INLINE;
+}
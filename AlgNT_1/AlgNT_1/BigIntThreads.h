@@ -0,0 +1,161 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <algorithm>
+
+//Thread pool for parallel multiplication of huge numbers.
+//A thread which waits for its tasks executes queued tasks itself,
+//so tasks may start nested tasks without deadlocks.
+namespace BigIntUtility {
+
+	class ThreadPool {
+		typedef std::function<void()> Task;
+
+		//tasks of one run call. Its caller sleeps on cv until they end or new tasks are queued
+		struct Batch {
+			std::atomic<size_t> left;
+			std::exception_ptr error;
+			std::mutex em;
+			std::condition_variable cv;
+		};
+
+		std::vector<std::thread> workers;
+		std::deque<Task> queue;
+		std::mutex m;
+		std::condition_variable cv;
+		bool stop = false;
+		//batches whose callers sleep, guarded by m
+		std::vector<Batch *> waiting;
+
+		void work() {
+			for (;;) {
+				Task t;
+				{
+					std::unique_lock<std::mutex> lock(m);
+					cv.wait(lock, [this]() { return stop || !queue.empty(); });
+					if (stop && queue.empty())
+						return;
+					t = std::move(queue.front());
+					queue.pop_front();
+				}
+				t();
+			}
+		}
+
+		void join() {
+			{
+				std::lock_guard<std::mutex> lock(m);
+				stop = true;
+			}
+			cv.notify_all();
+			for (auto & w : workers)
+				w.join();
+			workers.clear();
+			stop = false;
+		}
+
+	public:
+		ThreadPool() {}
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool & operator=(const ThreadPool &) = delete;
+		~ThreadPool() {
+			join();
+		}
+
+		//number of worker threads, 0 means that everything is done by the calling thread
+		size_t size() const {
+			return workers.size();
+		}
+
+		//sets the number of worker threads. Must not be called while tasks run
+		void resize(size_t n) {
+			join();
+			for (size_t i = 0; i < n; ++i)
+				workers.emplace_back([this]() { work(); });
+		}
+
+		//runs all the tasks and waits for them. The first exception thrown by a task is rethrown
+		void run(std::vector<Task> & tasks) {
+			if (tasks.empty())
+				return;
+			if (workers.empty() || tasks.size() == 1) {
+				for (auto & t : tasks)
+					t();
+				return;
+			}
+
+			auto batch = std::make_shared<Batch>();
+			batch->left = tasks.size();
+			auto wrap = [this, batch](Task & t) {
+				return [this, batch, &t]() {
+					try {
+						t();
+					}
+					catch (...) {
+						std::lock_guard<std::mutex> lock(batch->em);
+						if (!batch->error)
+							batch->error = std::current_exception();
+					}
+					if (--batch->left == 0) {
+						std::lock_guard<std::mutex> lock(m);
+						batch->cv.notify_all();
+					}
+				};
+			};
+
+			{
+				std::lock_guard<std::mutex> lock(m);
+				for (size_t i = 1; i < tasks.size(); ++i)
+					queue.push_back(wrap(tasks[i]));
+				//the waiting callers help with the new tasks too
+				for (auto b : waiting)
+					b->cv.notify_all();
+			}
+			cv.notify_all();
+			wrap(tasks[0])();
+
+			//the caller executes queued tasks while its own ones run on other threads, and sleeps when there are none
+			std::unique_lock<std::mutex> lock(m);
+			waiting.push_back(batch.get());
+			while (batch->left > 0) {
+				if (queue.empty()) {
+					batch->cv.wait(lock);
+					continue;
+				}
+				Task t = std::move(queue.front());
+				queue.pop_front();
+				lock.unlock();
+				t();
+				lock.lock();
+			}
+			waiting.erase(std::find(waiting.begin(), waiting.end(), batch.get()));
+			lock.unlock();
+			if (batch->error)
+				std::rethrow_exception(batch->error);
+		}
+
+		//calls f(begin, end) for parts of [0, n), at most one part per thread
+		void parallel_for(size_t n, const std::function<void(size_t, size_t)> & f) {
+			size_t parts = std::min(n, workers.size() + 1);
+			std::vector<Task> tasks;
+			for (size_t i = 0; i < parts; ++i) {
+				size_t b = n * i / parts, e = n * (i + 1) / parts;
+				tasks.push_back([&f, b, e]() { f(b, e); });
+			}
+			run(tasks);
+		}
+	};
+
+	//the pool used by BigInt_t
+	inline ThreadPool & thread_pool() {
+		static ThreadPool pool;
+		return pool;
+	}
+}
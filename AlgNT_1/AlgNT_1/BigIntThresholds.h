@@ -0,0 +1,75 @@
+#pragma once
+
+#include <climits>
+
+//Crossover sizes of BigInt_t algorithms in limbs of SIZE bits.
+//Written by the Tune program (AlgNT_1/Tune) except the values marked as set by hand. A rerun of Tune
+//on the target machine replaces the whole table.
+namespace BigIntUtility {
+
+	template<int SIZE> struct thresholds {};
+
+	template<> struct thresholds<8> {
+		static const unsigned int KARATSUBA_LIMIT = 24;
+		static const unsigned int TOOM3_LIMIT = 174;
+		static const unsigned int TOOM4_LIMIT = 626;
+		static const unsigned int NTT_LIMIT = 876;
+		static const unsigned int SQR_KARATSUBA_LIMIT = 44;
+		static const unsigned int SQR_TOOM3_LIMIT = 427;
+		static const unsigned int SQR_TOOM4_LIMIT = 759;
+		static const unsigned int SQR_NTT_LIMIT = 759;
+		static const unsigned int DIV_BZ_LIMIT = 111;
+		static const unsigned int DIV_NEWTON_LIMIT = 6000;
+		static const unsigned int DIVEXACT_LIMIT = 1400;
+		static const unsigned int TO_STRING_DC_LIMIT = 27;
+		static const unsigned int FROM_STRING_DC_LIMIT = 12;
+	};
+
+	template<> struct thresholds<16> {
+		static const unsigned int KARATSUBA_LIMIT = 21;
+		static const unsigned int TOOM3_LIMIT = 370;
+		static const unsigned int TOOM4_LIMIT = 407;
+		static const unsigned int NTT_LIMIT = 3299;
+		static const unsigned int SQR_KARATSUBA_LIMIT = 81;
+		static const unsigned int SQR_TOOM3_LIMIT = 493;
+		static const unsigned int SQR_TOOM4_LIMIT = 796;
+		static const unsigned int SQR_NTT_LIMIT = 3407;
+		static const unsigned int DIV_BZ_LIMIT = 89;
+		static const unsigned int DIV_NEWTON_LIMIT = 10000;
+		static const unsigned int DIVEXACT_LIMIT = 1273;
+		static const unsigned int TO_STRING_DC_LIMIT = 23;
+		static const unsigned int FROM_STRING_DC_LIMIT = 12;
+	};
+
+	template<> struct thresholds<32> {
+		static const unsigned int KARATSUBA_LIMIT = 27;
+		static const unsigned int TOOM3_LIMIT = 370;
+		static const unsigned int TOOM4_LIMIT = 919;
+		static const unsigned int NTT_LIMIT = 6737;
+		static const unsigned int SQR_KARATSUBA_LIMIT = 44;
+		static const unsigned int SQR_TOOM3_LIMIT = 542;
+		static const unsigned int SQR_TOOM4_LIMIT = 1420;
+		static const unsigned int SQR_NTT_LIMIT = 6737;
+		static const unsigned int DIV_BZ_LIMIT = 159;
+		static const unsigned int DIV_NEWTON_LIMIT = 30000; //by hand: 2n/n division timings, BZ against Newton
+		static const unsigned int DIVEXACT_LIMIT = 1540;
+		static const unsigned int TO_STRING_DC_LIMIT = 24;
+		static const unsigned int FROM_STRING_DC_LIMIT = 19;
+	};
+
+	template<> struct thresholds<64> {
+		static const unsigned int KARATSUBA_LIMIT = 28;
+		static const unsigned int TOOM3_LIMIT = 370;
+		static const unsigned int TOOM4_LIMIT = 759;
+		static const unsigned int NTT_LIMIT = 57570;
+		static const unsigned int SQR_KARATSUBA_LIMIT = 46;
+		static const unsigned int SQR_TOOM3_LIMIT = 569;
+		static const unsigned int SQR_TOOM4_LIMIT = 835;
+		static const unsigned int SQR_NTT_LIMIT = 54829;
+		static const unsigned int DIV_BZ_LIMIT = 128;
+		static const unsigned int DIV_NEWTON_LIMIT = 110000; //by hand: 2n/n division timings, BZ against Newton
+		static const unsigned int DIVEXACT_LIMIT = 1540;
+		static const unsigned int TO_STRING_DC_LIMIT = 37;
+		static const unsigned int FROM_STRING_DC_LIMIT = 100;
+	};
+}
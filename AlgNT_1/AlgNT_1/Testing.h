@@ -5,9 +5,11 @@
 #include <fstream>
 #include <map>
 #include <set>
+#include <vector>
 #include <exception>
 #include <ctime>
 #include "BigInt.h"
+#include "BigIntFixed.h"
 
 double getCPUTime();
 
@@ -59,7 +61,7 @@ namespace Testing {
 	};
 
 	enum class TestType {
-		IO, UNARY, BINARY, SHIFTS, COMP
+		IO, UNARY, BINARY, SHIFTS, COMP, POWMOD, MULADD, DIV
 	};
 
 	auto MAX = std::numeric_limits<int>::max();
@@ -69,13 +71,19 @@ namespace Testing {
 		{ "ua", TestType::UNARY },
 		{ "ba", TestType::BINARY },
 		{ "shifts", TestType::SHIFTS },
-		{ "comp", TestType::COMP } };
+		{ "comp", TestType::COMP },
+		{ "pm", TestType::POWMOD },
+		{ "ma", TestType::MULADD },
+		{ "dv", TestType::DIV } };
 	std::map<TestType, int> res_number = {
 		{ TestType::IO, 1 },
 		{ TestType::UNARY, 1 },
 		{ TestType::BINARY, 5 },
 		{ TestType::SHIFTS, 2 },
-		{ TestType::COMP, 1 } };
+		{ TestType::COMP, 1 },
+		{ TestType::POWMOD, 1 },
+		{ TestType::MULADD, 6 },
+		{ TestType::DIV, 2 } };
 	std::string txt_res[] = { "FAIL", "OK" };
 
 	Table test_correctness(std::string tests_path, int tests_limit = MAX) {
@@ -101,7 +109,7 @@ namespace Testing {
 			std::string inp;
 			std::string tmp;
 			bool res[10];
-			BI A, B;
+			BI A, B, C, D;
 			int n;
 
 			for (int j = 0; j < NTESTS; ++j) {
@@ -165,6 +173,45 @@ namespace Testing {
 					f >> inp;
 					res[4] = (A % B).to_string() == inp;
 					break;
+
+				case TestType::POWMOD:
+					f >> A >> B >> C;
+					f >> inp;
+					res[0] = BI::powmod(A, B, C).to_string() == inp;
+					break;
+
+				case TestType::MULADD:
+					f >> A >> B >> C >> D;
+
+					f >> inp;
+					res[0] = (C + A * B).to_string() == inp;
+
+					f >> inp;
+					res[1] = (C - A * B).to_string() == inp;
+
+					f >> inp;
+					res[2] = (A * B - C).to_string() == inp;
+
+					f >> inp;
+					res[3] = (A * B + C * D).to_string() == inp;
+
+					f >> inp;
+					res[4] = (A * B - C * D).to_string() == inp;
+
+					f >> inp;
+					res[5] = (-(A * B)).to_string() == inp;
+					break;
+
+				case TestType::DIV:
+					f >> A >> B;
+					A.div(B, C, D);
+
+					f >> inp;
+					res[0] = C.to_string() == inp;
+
+					f >> inp;
+					res[1] = D.to_string() == inp;
+					break;
 				}
 
 				for (int k = 0; k < res_number[type]; ++k) {
@@ -191,11 +238,11 @@ namespace Testing {
 	};
 
 	enum class TestTypeTime {
-		INPUT, OUTPUT, UNARY, ADD, SUB, RSHIFT, LSHIFT, COMP, MULT, DIV
+		INPUT, OUTPUT, UNARY, ADD, SUB, RSHIFT, LSHIFT, COMP, MULT, SQR, DIV
 	};
 	std::map<TestTypeTime, std::tuple<std::string, int, int, int>> type_to_s = {
 		{ TestTypeTime::INPUT,		std::make_tuple("input",		5000, 20,	25) },
-		{ TestTypeTime::OUTPUT,		std::make_tuple("output",		500, 20,	8 ) },
+		{ TestTypeTime::OUTPUT,		std::make_tuple("output",		500, 20,	40 ) },
 		{ TestTypeTime::UNARY,		std::make_tuple("unary",		500, 1,		100000 ) },
 		{ TestTypeTime::ADD,		std::make_tuple("add",			500, 100,	100000 ) },
 		{ TestTypeTime::SUB,		std::make_tuple("sub",			500, 100,	100000 ) },
@@ -203,9 +250,137 @@ namespace Testing {
 		{ TestTypeTime::LSHIFT,		std::make_tuple("left_sh",		500, 100,	50000 ) },
 		{ TestTypeTime::COMP,		std::make_tuple("comparison",	500, 100,	200000 ) },
 		{ TestTypeTime::MULT,		std::make_tuple("mult",		500, 100,	50 ) },
+		{ TestTypeTime::SQR,		std::make_tuple("sqr",			500, 100,	50 ) },
 		{ TestTypeTime::DIV,		std::make_tuple("div",			500, 100,	50 ) }
 	};
 
+	//multiplication methods timed in MULT series besides the automatic choice
+	std::list<BI::MultMethod> mult_methods = {
+		BI::MultMethod::KARATSUBA,
+		BI::MultMethod::TOOM3,
+		BI::MultMethod::TOOM4,
+		BI::MultMethod::NTT };
+
+	//methods checked by test_mult_correctness, the columns of its table
+	std::list<std::pair<BI::MultMethod, std::string>> checked_methods = {
+		{ BI::MultMethod::AUTO, "AUTO" },
+		{ BI::MultMethod::TOOM3, "TOOM3" },
+		{ BI::MultMethod::TOOM4, "TOOM4" },
+		{ BI::MultMethod::TOOM32, "TOOM32" },
+		{ BI::MultMethod::TOOM42, "TOOM42" },
+		{ BI::MultMethod::NTT, "NTT" } };
+
+	//BI::multiply(a, b, method) against the Karatsuba product on ntests random a of k limbs and b of l limbs.
+	//The methods not in the list are not tried on this shape, "-" in their columns
+	void test_mult_row(Table & t, size_t k, size_t l, int ntests, const std::set<BI::MultMethod> & methods) {
+		std::map<BI::MultMethod, bool> ok;
+		for (auto method : methods)
+			ok[method] = true;
+		for (int i = 0; i < ntests; ++i) {
+			BI a = BI::get_random((unsigned)k), b = BI::get_random((unsigned)l);
+			BI c = BI::multiply(a, b, BI::MultMethod::KARATSUBA);
+			for (auto method : methods)
+				ok[method] = ok[method] && BI::multiply(a, b, method) == c;
+		}
+
+		std::list<std::string> row = { std::to_string(k), std::to_string(l) };
+		for (auto & m : checked_methods)
+			row.push_back(ok.count(m.first) ? txt_res[ok[m.first]] : "-");
+		t.add_row(row);
+	}
+
+	Table test_mult_correctness(int ntests = 10) {
+		std::list<std::string> header = { "k", "l" };
+		for (auto & m : checked_methods)
+			header.push_back(m.second);
+		Table t(header);
+
+		std::set<BI::MultMethod> all;
+		for (auto & m : checked_methods)
+			all.insert(m.first);
+		test_mult_row(t, 30, 20, ntests, all);
+		test_mult_row(t, 600, 600, ntests, all);
+		test_mult_row(t, 2000, 1500, ntests, all);
+		//unbalanced operands from TOOM3_LIMIT: AUTO takes TOOM32 for 3:2, TOOM42 for 2:1 and the chunks for 3:1 and 5:2
+		test_mult_row(t, 900, 600, ntests, all);
+		test_mult_row(t, 1200, 600, ntests, all);
+		test_mult_row(t, 1800, 600, ntests, all);
+		test_mult_row(t, 1500, 600, ntests, all);
+		test_mult_row(t, 3000, 1000, ntests, all);
+		//the 32-bit digits don't fit NTT_MAX_LENGTH_32, ntt_mult cuts the operands into 16-bit ones
+		test_mult_row(t, BigIntUtility::NTT_MAX_LENGTH_32, 1000, 1, { BI::MultMethod::NTT });
+		return t;
+	}
+
+	//division from DIV_NEWTON_LIMIT on BigInt_t<8>, where the limit is the smallest: div_newton, reciprocal,
+	//div_barrett and div_barrett_blocks. Q * D + R == A and R of the sign of D, |R| < |D| on ntests random pairs
+	//of both signs; the exact quotient q for A = q * D and A = q * D + D - 1, the ends of the remainder range
+	Table test_newton_div_correctness(int ntests = 3) {
+		typedef BigInt_t<8> B;
+		Table t({ "k", "l", "random", "R = 0", "R = D - 1" });
+		const size_t n = B::DIV_NEWTON_LIMIT;
+		//2n/n by div_barrett, 3n/n by div_barrett_blocks, a divisor longer than the quotient is cut first
+		const size_t shapes[][2] = { { 2 * n, n }, { 3 * n, n }, { 5 * n / 2, 3 * n / 2 } };
+
+		for (auto & sh : shapes) {
+			bool ok[3] = { true, true, true };
+			for (int i = 0; i < ntests; ++i) {
+				B a = B::get_random((unsigned)sh[0]), d = B::get_random((unsigned)sh[1]), Q, R;
+				a.div(d, Q, R);
+				ok[0] = ok[0] && Q * d + R == a && R.abs() < d.abs() && (R.isNull() || R.isNeg() == d.isNeg());
+
+				B q = B::get_random((unsigned)(sh[0] - sh[1] + 1)).abs();
+				d = d.abs();
+				a = q * d;
+				a.div(d, Q, R);
+				ok[1] = ok[1] && Q == q && R.isNull();
+				B r = d - B(1);
+				a += r;
+				a.div(d, Q, R);
+				ok[2] = ok[2] && Q == q && R == r;
+			}
+
+			std::list<std::string> row = { std::to_string(sh[0]), std::to_string(sh[1]) };
+			for (int j = 0; j < 3; ++j)
+				row.push_back(txt_res[ok[j]]);
+			t.add_row(row);
+		}
+		return t;
+	}
+
+	//products of operands from parallelLimit limbs by the given number of worker threads against the serial ones:
+	//the parallel Karatsuba, Toom and NTT levels, the chunked product of unbalanced operands and squaring
+	Table test_parallel_correctness(size_t threads = 4, int ntests = 3) {
+		Table t({ "k", "l", "threads", "AUTO", "KARATSUBA", "TOOM3", "TOOM4", "NTT", "sqr" });
+		const BI::MultMethod methods[] = {
+			BI::MultMethod::AUTO, BI::MultMethod::KARATSUBA, BI::MultMethod::TOOM3, BI::MultMethod::TOOM4, BI::MultMethod::NTT };
+		const size_t shapes[][2] = { { 3000, 3000 }, { 8000, 8000 }, { 12000, 3000 } };
+
+		for (auto & sh : shapes) {
+			bool ok[6] = { true, true, true, true, true, true };
+			for (int i = 0; i < ntests; ++i) {
+				BI a = BI::get_random((unsigned)sh[0]), b = BI::get_random((unsigned)sh[1]);
+				BI serial[6];
+				BI::set_threads(0);
+				for (int j = 0; j < 5; ++j)
+					serial[j] = BI::multiply(a, b, methods[j]);
+				serial[5] = a.square();
+
+				BI::set_threads(threads);
+				for (int j = 0; j < 5; ++j)
+					ok[j] = ok[j] && BI::multiply(a, b, methods[j]) == serial[j];
+				ok[5] = ok[5] && a.square() == serial[5];
+			}
+			BI::set_threads(0);
+
+			std::list<std::string> row = { std::to_string(sh[0]), std::to_string(sh[1]), std::to_string(threads) };
+			for (int j = 0; j < 6; ++j)
+				row.push_back(txt_res[ok[j]]);
+			t.add_row(row);
+		}
+		return t;
+	}
+
 	void test_time(std::string prefix, std::set<TestTypeTime> set_of_types) {
 		srand((unsigned)time(0));
 		for (auto type_p : type_to_s) {
@@ -227,6 +402,7 @@ namespace Testing {
 				Timer tim;
 				double res;
 				int rlen = len;
+				std::list<std::string> row;
 
 				if (type == TestTypeTime::DIV)
 					A = BI::get_random(len * 3 / 2);
@@ -239,6 +415,8 @@ namespace Testing {
 					type == TestTypeTime::DIV ||
 					type == TestTypeTime::COMP)
 					B = BI::get_random(len);
+				if (type == TestTypeTime::SQR)
+					B = A;
 				if (type == TestTypeTime::LSHIFT ||
 					type == TestTypeTime::RSHIFT)
 					sh = rand() % 10000;
@@ -294,6 +472,20 @@ namespace Testing {
 					tim.start();
 					C = A * B;
 					res = tim.get();
+					for (auto method : mult_methods) {
+						tim.start();
+						C = BI::multiply(A, B, method);
+						row.push_back(std::to_string(tim.get()));
+					}
+					break;
+				case Testing::TestTypeTime::SQR:
+					tim.start();
+					C = A.square();
+					res = tim.get();
+					//the same product by general multiplication, B is a copy of A
+					tim.start();
+					C = A * B;
+					row.push_back(std::to_string(tim.get()));
 					break;
 				case Testing::TestTypeTime::DIV:
 					tim.start();
@@ -305,7 +497,10 @@ namespace Testing {
 				}
 
 				p += C.isNeg();
-				t.add_row({std::to_string(k), std::to_string(rlen), std::to_string(res)});
+				row.push_front(std::to_string(res));
+				row.push_front(std::to_string(rlen));
+				row.push_front(std::to_string(k));
+				t.add_row(row);
 			}
 
 			std::ofstream of(prefix + type_str + ".csv");
@@ -313,4 +508,158 @@ namespace Testing {
 			of.close();
 		}
 	}
+
+	//FixedBigInt<BITS, SIZE> against BigInt_t<_SIZE> modulo 2^BITS on ntests random pairs of both signs and up to
+	//BITS + 2 * _SIZE bits. mult, sqr and mul_full cover the schoolbook and the Karatsuba path of FixedBigInt,
+	//sqr and mul_full(a) with the operand itself take its squaring branch
+	template<unsigned BITS, int SIZE, int _SIZE>
+	void test_fixed_correctness_row(Table & t, int ntests) {
+		typedef BigInt_t<_SIZE> B;
+		typedef FixedBigInt<BITS, SIZE> F;
+		const B M = B(1) << (long long)BITS;
+		auto mod = [&](const B & x) { return (x % M + M) % M; };
+		auto same = [](const F & x, const B & y) { return x.template to_BigInt<_SIZE>() == y; };
+
+		bool res[9];
+		std::fill(res, res + 9, true);
+		for (int i = 0; i < ntests; ++i) {
+			B a = i == 0 ? B(-1) : B::get_random(rand() % (BITS / _SIZE + 3));
+			B b = i == 0 ? B(-1) : B::get_random(rand() % (BITS / _SIZE + 3));
+			unsigned sh = rand() % BITS;
+			F fa(a), fb(b);
+			B ma = mod(a), mb = mod(b);
+
+			res[0] = res[0] && same(fa, ma) && same(fb, mb);
+			res[1] = res[1] && same(fa + fb, mod(a + b));
+			res[2] = res[2] && same(fa - fb, mod(a - b));
+			res[3] = res[3] && same(fa * fb, mod(a * b));
+			F s = fa;
+			s *= s;
+			res[4] = res[4] && same(s, mod(a * a)) && fa.mul_full(fa).template to_BigInt<_SIZE>() == ma * ma;
+			res[5] = res[5] && fa.mul_full(fb).template to_BigInt<_SIZE>() == ma * mb;
+			res[6] = res[6] && same(fa << sh, mod(ma << (long long)sh));
+			res[7] = res[7] && same(fa >> sh, ma >> (long long)sh);
+			res[8] = res[8] && F(fa.to_BigInt()) == fa;
+		}
+
+		std::list<std::string> row = { std::to_string(BITS), std::to_string(SIZE), std::to_string(_SIZE) };
+		for (int k = 0; k < 9; ++k)
+			row.push_back(txt_res[res[k]]);
+		t.add_row(row);
+	}
+
+	template<unsigned BITS>
+	void test_fixed_correctness_bits(Table & t, int ntests) {
+		test_fixed_correctness_row<BITS, 32, 32>(t, ntests);
+#if defined(__SIZEOF_INT128__)
+		test_fixed_correctness_row<BITS, 32, 64>(t, ntests);
+		test_fixed_correctness_row<BITS, 64, 32>(t, ntests);
+		test_fixed_correctness_row<BITS, 64, 64>(t, ntests);
+#endif
+	}
+
+	//FixedBigInt arithmetic and conversions checked by BigInt_t, N from 4 to 1024 limbs: below and above KARATSUBA_LIMIT
+	Table test_fixed_correctness(int ntests = 100) {
+		srand((unsigned)time(0));
+		Table t({ "bits", "limb", "BigInt_t limb", "conv", "add", "sub", "mult", "sqr", "mul_full", "left_sh", "right_sh", "to_BigInt" });
+		test_fixed_correctness_bits<256>(t, ntests);
+		test_fixed_correctness_bits<1024>(t, ntests);
+		test_fixed_correctness_bits<4096>(t, ntests);
+		test_fixed_correctness_bits<8192>(t, ntests);
+		//1024 limbs: Unroll has to keep the depth of instantiation logarithmic
+		test_fixed_correctness_row<8192, 8, 32>(t, ntests);
+		return t;
+	}
+
+	//count of different operands of test_fixed_time, an operation is timed on all their pairs in turn
+	const size_t FIXED_OPERANDS = 16;
+
+	//average time of op(x[i], y[i]) in ns
+	template<typename T, typename Op>
+	double time_per_op(const std::vector<T> & x, const std::vector<T> & y, int reps, Op op, int & p) {
+		Timer tim;
+		tim.start();
+		for (int i = 0; i < reps; ++i)
+			p += op(x[i % FIXED_OPERANDS], y[i % FIXED_OPERANDS]);
+		return tim.get() / reps * 1e9;
+	}
+
+	//times of add, sub, mult (the whole product), comparison and left_sh of BITS bit numbers by
+	//BigInt_t<32>, BigInt_t<64>, FixedBigInt<BITS, 32>, FixedBigInt<BITS, 64>
+	template<unsigned BITS>
+	void test_fixed_row(Table & t, int reps, int & p) {
+		typedef BigInt_t<32> B32;
+		typedef FixedBigInt<BITS, 32> F32;
+		std::vector<B32> xb32, yb32;
+		std::vector<F32> xf32, yf32;
+		for (size_t i = 0; i < FIXED_OPERANDS; ++i) {
+			xf32.push_back(F32(B32::get_random(BITS / 32)));
+			yf32.push_back(F32(B32::get_random(BITS / 32)));
+			xb32.push_back(xf32[i].to_BigInt());
+			yb32.push_back(yf32[i].to_BigInt());
+		}
+#if defined(__SIZEOF_INT128__)
+		typedef BigInt_t<64> B64;
+		typedef FixedBigInt<BITS, 64> F64;
+		std::vector<B64> xb64, yb64;
+		std::vector<F64> xf64, yf64;
+		for (size_t i = 0; i < FIXED_OPERANDS; ++i) {
+			xb64.push_back(xf32[i].template to_BigInt<64>());
+			yb64.push_back(yf32[i].template to_BigInt<64>());
+			xf64.push_back(F64(xb64[i]));
+			yf64.push_back(F64(yb64[i]));
+		}
+#endif
+		int sh = BITS / 3;
+		auto row = [&](std::string name, int r, auto b_op, auto f_op) {
+			std::list<std::string> res = { std::to_string(BITS), name };
+			res.push_back(std::to_string(time_per_op(xb32, yb32, r, b_op, p)));
+#if defined(__SIZEOF_INT128__)
+			res.push_back(std::to_string(time_per_op(xb64, yb64, r, b_op, p)));
+#endif
+			res.push_back(std::to_string(time_per_op(xf32, yf32, r, f_op, p)));
+#if defined(__SIZEOF_INT128__)
+			res.push_back(std::to_string(time_per_op(xf64, yf64, r, f_op, p)));
+#endif
+			t.add_row(res);
+		};
+		row("add", reps,
+			[](const auto & a, const auto & b) { return (int)(a + b).isOdd(); },
+			[](const auto & a, const auto & b) { return (int)(a + b).bit(BITS - 1); });
+		row("sub", reps,
+			[](const auto & a, const auto & b) { return (int)(a - b).isOdd(); },
+			[](const auto & a, const auto & b) { return (int)(a - b).bit(BITS - 1); });
+		row("mult", reps / 10,
+			[](const auto & a, const auto & b) { return (int)(a * b).isOdd(); },
+			[](const auto & a, const auto & b) { return (int)a.mul_full(b).bit(2 * BITS - 1); });
+		row("comparison", reps,
+			[](const auto & a, const auto & b) { return a.compare(b); },
+			[](const auto & a, const auto & b) { return a.compare(b); });
+		row("left_sh", reps,
+			[sh](const auto & a, const auto &) { return (int)(a << sh).isOdd(); },
+			[sh](const auto & a, const auto &) { return (a << (unsigned)sh).compare(a); });
+	}
+
+	//FixedBigInt against BigInt_t on numbers of 256 to 4096 bits, times of one operation in ns
+	void test_fixed_time(std::string prefix, int reps = 200000) {
+		Table t({ "bits", "operation", "BigInt_t32",
+#if defined(__SIZEOF_INT128__)
+			"BigInt_t64",
+#endif
+			"FixedBigInt32",
+#if defined(__SIZEOF_INT128__)
+			"FixedBigInt64"
+#endif
+		});
+		int p = 0;
+		test_fixed_row<256>(t, reps, p);
+		test_fixed_row<512>(t, reps, p);
+		test_fixed_row<1024>(t, reps / 4, p);
+		test_fixed_row<2048>(t, reps / 16, p);
+		test_fixed_row<4096>(t, reps / 64, p);
+
+		std::ofstream of(prefix + "fixed.csv");
+		of << t;
+		of.close();
+	}
 }
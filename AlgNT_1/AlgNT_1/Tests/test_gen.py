@@ -35,8 +35,8 @@ def rsnum(n):
 f = open("tests.txt", "w");
 BASE = 10
 WRITE_RESULTS = True
-#5 серий тестов
-f.write("5\n");
+#8 серий тестов
+f.write("8\n");
 
 #input/output
 NTESTS = 300
@@ -108,4 +108,49 @@ for i in range(NTESTS):
     else:
         f.write(s1 + " " + s2 + "\n");
 
+#modular exponentiation: odd moduli go through Montgomery form, even ones through BigIntDivisor
+NTESTS = 300;
+f.write("pm " + str(NTESTS) +"\n");
+for i in range(NTESTS):
+    a = int(rsnum(rand_int(0, (i+1)*10)), BASE)
+    e = int(rnum(rand_int(0, 60)), BASE)
+    m = int(rsnum(rand_int(1, (i+1)*5)), BASE)
+    if i % 2 == 0:
+        m |= 1
+    elif m % 2 != 0:
+        m += 1 if m > 0 else -1
+    if i % 25 == 0:
+        e = 0
+    if i % 25 == 1:
+        m = 1 if m > 0 else -1
+    f.write(str(a) + " " + str(e) + " " + str(m) + " " + str(pow(a, e, abs(m))) + "\n");
+
+#sums and differences with products: the operands of + and - are temporaries
+NTESTS = 300;
+f.write("ma " + str(NTESTS) +"\n");
+for i in range(NTESTS):
+    a = int(rsnum(rand_int(0, (i+1)*10)), BASE)
+    b = int(rsnum(rand_int(0, (i+1)*10)), BASE)
+    c = int(rsnum(rand_int(0, (i+1)*25)), BASE)
+    d = int(rsnum(rand_int(0, (i+1)*10)), BASE)
+    f.write(" ".join(str(x) for x in [a, b, c, d, c + a*b, c - a*b, a*b - c, a*b + c*d, a*b - c*d, -(a*b)]) + "\n");
+
+#division by long divisors: from 2000 to 38000 digits, 200 to 2000 64-bit limbs, the dividend 2 to 4 times longer,
+#so that the quotient is as long as the divisor and Burnikel-Ziegler is used. Every 5th divisor has all ones in its
+#top limbs and the quotient has all ones in all limbs, the case when a digit of the quotient can't be estimated
+NTESTS = 50;
+f.write("dv " + str(NTESTS) +"\n");
+for i in range(NTESTS):
+    lb = rand_int(2000 + i*720, 2000 + (i+1)*720)
+    b = int(rsnum(lb), BASE)
+    a = int(rsnum(lb * (2 + i%3)), BASE)
+    if i % 5 == 4:
+        bits = b.bit_length() // 64 * 64
+        b = (1 << bits) - rand_int(1, 1000)
+        q = (1 << (bits * (1 + i%3))) - 1
+        a = b*q + int(rnum(lb), BASE) % b
+        if rand_int(0, 1) == 1:
+            a = -a
+    f.write(str(a) + " " + str(b) + " " + str(a//b) + " " + str(a%b) + "\n");
+
 f.close();
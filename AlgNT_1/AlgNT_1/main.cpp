@@ -61,6 +61,26 @@ int main() {
 	of << t;
 	of.close();
 
+	t = Testing::test_fixed_correctness();
+	of.open("Tests/fixed_correctness_res.csv");
+	of << t;
+	of.close();
+
+	t = Testing::test_mult_correctness();
+	of.open("Tests/mult_correctness_res.csv");
+	of << t;
+	of.close();
+
+	t = Testing::test_newton_div_correctness();
+	of.open("Tests/newton_div_correctness_res.csv");
+	of << t;
+	of.close();
+
+	t = Testing::test_parallel_correctness();
+	of.open("Tests/parallel_correctness_res.csv");
+	of << t;
+	of.close();
+
 //    BigInt_t t("4445345346234665652454542643625757472486482564");
 //	std::cout << bool(t) <<"\n";
 //	system("pause");
@@ -77,9 +97,12 @@ int main() {
 		TestTypeTime::LSHIFT,
 		TestTypeTime::COMP,
 		TestTypeTime::MULT,
+		TestTypeTime::SQR,
 		TestTypeTime::DIV
 	});
 
+	Testing::test_fixed_time("Tests/");
+
 
 	//BigInt_t a("546894577228424860317710428378087183702578831913536555262070398815845737725138865627427897435658025469056748521133376834030120225806811396222095781059187989524212652289408638890143999083839741005656252235360937303596970254551696814995744441280545141714660176687986307678108194510607159584411456032479006909097649618019232998051738155490713112759926350931272158455116560940810734305733296121007848483687778056456459432187718913168062486253464130408890546873741924272468297238610563276091887946058653217489853482201641987701376012521235034265521746293539944579118868041471622031750234336918592415692293555466571764331526642979447660894494781237235650404026029882229849641885587529877208844701969753528680579247190649218269444971983857134430393410494671833552140922252666277243423224864853370730686781722339482911325611494092191266775812346472786267870561888739335520793992275561863100980197480676009580758744959099717756166792248405101050391400929086726320694835789307458400103664016292578820990244385936847399989351054595076788531084593341116947811887374536314658877401018067447420832109130205407084318095870040028827881255409339073645089797891850773283126722102119374345149822875234606507369787861135461695609232241423680875457207887007953886633434007484138065855394866808812772204369114171147559988007302155903556574301426428262417614477120380601885659995711494922278505698878735856619386372832149904065857344805389495685093695416847184917090645853182140119322768378842211109868016838216506003007676728384211784628724527645409314379592694717503108461084380969701396662818647010284729358542351742019999953584742325409944762092402068423038663604739");
 	//BigInt_t b("-3501046834570469271216903877770075077609570240147599422489064484559922035793995730523064292911703064789206570593275745734335624091432263718641250541866279986611305402298147883689889987044498418013098433405764981231160964186378665496473380631830377821581481160480354393835741181625930482282685378208438680036597725510629038717053129735324002466492198488216987373873042311896809470858358967227680934865152743401584573845189729280340118102421928469046297500014079378348560891092625890852510042242035217530268150132200309800088967562501219349180758015675002981590830938248033496409233574301424408891478241342949123964546268710611892639351692658800137496827059178818124394617204909766882860843904363155191203031080097916190320124006667956709877100711688075339888275256095460400675253958815141996562397491449849951364918097418358455215168513546733081270391046280971317125831092905904843836709644279744041983153587012011571629235885383379989463917765266186061876714673116947607672684176938728594062914653231103093426036927318213427885048974351277206487093574597927405828885217855691549323736750092905229199386232884195917467354237680547492421875231426130374252926064623955840744915325551300472600354950299500408926782749456234869600110176899667984637846853428581995945960118824093682466682700076464572201163192250964192775258110161983808225786635342759753600181414782821310279870027074992755851714377800758673952012683379731445576695684479231838407194970596813758790990291");
@@ -7,7 +7,15 @@ set output "graph_sub.png"
 plot "time_res_sub.csv" using 2:3 with lines
 
 set output "graph_mult.png"
-plot "time_res_mult.csv" using 2:3 with lines
+plot "time_res_mult.csv" using 2:3 with lines title "auto", \
+	"time_res_mult.csv" using 2:4 with lines title "karatsuba", \
+	"time_res_mult.csv" using 2:5 with lines title "toom3", \
+	"time_res_mult.csv" using 2:6 with lines title "toom4", \
+	"time_res_mult.csv" using 2:7 with lines title "ntt"
+
+set output "graph_sqr.png"
+plot "time_res_sqr.csv" using 2:3 with lines title "square", \
+	"time_res_sqr.csv" using 2:4 with lines title "mult"
 
 set output "graph_div.png"
 plot "time_res_div.csv" using 2:3 with lines
@@ -76,6 +76,7 @@ int main() {
 		TestTypeTime::LSHIFT,
 		TestTypeTime::COMP,
 		TestTypeTime::MULT,
+		TestTypeTime::SQR,
 		TestTypeTime::DIV
 	});*/
 
@@ -0,0 +1,263 @@
+//Tune program: measures crossover sizes of BigInt_t algorithms on this machine
+//and writes them to BigIntThresholds.h, which is included by BigInt.h.
+//
+//Usage: Tune [-o header] [SIZE ...]
+//Sizes of limb which are not given (or not supported by the compiler) keep their current thresholds.
+//
+//Like mpir-tune, every threshold is found by timing an operation on n-limb operands twice:
+//with the threshold equal to n (the algorithm is used on the top level only)
+//and equal to n + 1 (the previous algorithm is used). The threshold is the first n
+//from which the algorithm wins several times in a row.
+
+#if !defined(BIGINT_TUNE)
+	#error "Tune must be built with BIGINT_TUNE defined"
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <functional>
+#include <chrono>
+#include <limits>
+#include <cstdlib>
+#include <memory>
+#include <algorithm>
+
+#include "../AlgNT_1/BigInt.h"
+
+namespace Tune {
+	typedef std::vector<std::pair<std::string, unsigned int>> ThresholdList;
+
+	//minimal duration of one measurement in seconds
+	const double MIN_TIME = 0.005;
+	//number of measurements, the best one is taken
+	const int REPEATS = 3;
+	//number of consecutive wins which fix the threshold
+	const int WINS = 3;
+	//value which switches an algorithm off
+	const unsigned int DISABLED = std::numeric_limits<unsigned int>::max() - 1;
+	//threshold of an algorithm which didn't win anywhere in the scanned range, written as UINT_MAX.
+	//The upper bound of the range would claim a crossover which wasn't measured
+	const unsigned int NEVER = std::numeric_limits<unsigned int>::max();
+
+	//best time of one call of f in seconds
+	double measure(const std::function<void()> & f) {
+		double best = std::numeric_limits<double>::max();
+		for (int r = 0; r < REPEATS; ++r) {
+			long long calls = 0;
+			auto start = std::chrono::steady_clock::now();
+			double el;
+			do {
+				f();
+				++calls;
+				el = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			} while (el < MIN_TIME);
+			best = std::min(best, el / calls);
+		}
+		return best;
+	}
+
+	//tuned threshold: its variable, the operation on n-limb operands which depends on it
+	//and the scanned range of sizes in limbs (the upper bound is given for 32-bit limbs and scaled for other ones)
+	struct Param {
+		std::string name;
+		unsigned int & var;
+		std::function<std::function<void()>(size_t)> op;
+		size_t from, to;
+	};
+
+	size_t tune_param(Param & p, size_t from, size_t to) {
+		std::cout << p.name << ":\n";
+		int wins = 0;
+		size_t first = to;
+		for (size_t n = from; n <= to; n = std::max(n + 1, n * 21 / 20)) {
+			auto f = p.op(n);
+			p.var = (unsigned int)n;
+			double with = measure(f);
+			p.var = (unsigned int)n + 1;
+			double without = measure(f);
+
+			std::cout << "\t" << std::setw(8) << n << std::setw(14) << with << std::setw(14) << without << "\n";
+			if (with < without) {
+				if (!wins++)
+					first = n;
+				if (wins == WINS)
+					return first;
+			}
+			else {
+				wins = 0;
+			}
+		}
+		std::cout << "\tno crossover below " << to << "\n";
+		return NEVER;
+	}
+
+	//thresholds which are compiled in now
+	template<int SIZE>
+	ThresholdList current() {
+		typedef BigIntUtility::thresholds<SIZE> T;
+		return {
+			{ "KARATSUBA_LIMIT", T::KARATSUBA_LIMIT },
+			{ "TOOM3_LIMIT", T::TOOM3_LIMIT },
+			{ "TOOM4_LIMIT", T::TOOM4_LIMIT },
+			{ "NTT_LIMIT", T::NTT_LIMIT },
+			{ "SQR_KARATSUBA_LIMIT", T::SQR_KARATSUBA_LIMIT },
+			{ "SQR_TOOM3_LIMIT", T::SQR_TOOM3_LIMIT },
+			{ "SQR_TOOM4_LIMIT", T::SQR_TOOM4_LIMIT },
+			{ "SQR_NTT_LIMIT", T::SQR_NTT_LIMIT },
+			{ "DIV_BZ_LIMIT", T::DIV_BZ_LIMIT },
+			{ "DIV_NEWTON_LIMIT", T::DIV_NEWTON_LIMIT },
+			{ "DIVEXACT_LIMIT", T::DIVEXACT_LIMIT },
+			{ "TO_STRING_DC_LIMIT", T::TO_STRING_DC_LIMIT },
+			{ "FROM_STRING_DC_LIMIT", T::FROM_STRING_DC_LIMIT }
+		};
+	}
+
+	template<int SIZE>
+	ThresholdList tune() {
+		typedef BigInt_t<SIZE> BI;
+		std::cout << "SIZE = " << SIZE << "\n";
+
+		auto mul = [](size_t n) -> std::function<void()> {
+			auto a = std::make_shared<BI>(BI::get_random((unsigned)n)), b = std::make_shared<BI>(BI::get_random((unsigned)n));
+			return [a, b]() { BI c = *a * *b; };
+		};
+		auto sqr = [](size_t n) -> std::function<void()> {
+			auto a = std::make_shared<BI>(BI::get_random((unsigned)n));
+			return [a]() { BI c = a->square(); };
+		};
+		//the dividend is twice as long as the divisor
+		auto div = [](size_t n) -> std::function<void()> {
+			auto a = std::make_shared<BI>(BI::get_random(2 * (unsigned)n)), b = std::make_shared<BI>(BI::get_random((unsigned)n));
+			return [a, b]() { BI c = *a / *b; };
+		};
+		//n-limb quotient and divisor
+		auto divexact = [](size_t n) -> std::function<void()> {
+			auto b = std::make_shared<BI>(BI::get_random((unsigned)n));
+			auto a = std::make_shared<BI>(BI::get_random((unsigned)n) * *b);
+			return [a, b]() { BI c = BI::divexact(*a, *b); };
+		};
+		//decimal output of an n-limb number
+		auto to_str = [](size_t n) -> std::function<void()> {
+			auto a = std::make_shared<BI>(BI::get_random((unsigned)n));
+			return [a]() { std::string s = a->to_string(10); };
+		};
+		//parsing of the decimal string of an n-limb number
+		auto from_str = [](size_t n) -> std::function<void()> {
+			auto s = std::make_shared<std::string>(BI::get_random((unsigned)n).to_string(10));
+			return [s]() { BI a(*s, 10); };
+		};
+
+		//each group is tuned in order, later thresholds are switched off meanwhile
+		std::list<std::list<Param>> groups = {
+			{
+				{ "KARATSUBA_LIMIT", BI::KARATSUBA_LIMIT, mul, 8, 300 },
+				{ "TOOM3_LIMIT", BI::TOOM3_LIMIT, mul, 50, 2000 },
+				{ "TOOM4_LIMIT", BI::TOOM4_LIMIT, mul, 100, 4000 },
+				{ "NTT_LIMIT", BI::NTT_LIMIT, mul, 500, 200000 }
+			},
+			{
+				{ "SQR_KARATSUBA_LIMIT", BI::SQR_KARATSUBA_LIMIT, sqr, 8, 300 },
+				{ "SQR_TOOM3_LIMIT", BI::SQR_TOOM3_LIMIT, sqr, 50, 2000 },
+				{ "SQR_TOOM4_LIMIT", BI::SQR_TOOM4_LIMIT, sqr, 100, 4000 },
+				{ "SQR_NTT_LIMIT", BI::SQR_NTT_LIMIT, sqr, 500, 200000 }
+			},
+			{
+				{ "DIV_BZ_LIMIT", BI::DIV_BZ_LIMIT, div, 8, 2000 },
+				{ "DIV_NEWTON_LIMIT", BI::DIV_NEWTON_LIMIT, div, 20, 300000 }
+			},
+			{
+				{ "DIVEXACT_LIMIT", BI::DIVEXACT_LIMIT, divexact, 20, 8000 }
+			},
+			{
+				{ "TO_STRING_DC_LIMIT", BI::TO_STRING_DC_LIMIT, to_str, 4, 2000 }
+			},
+			{
+				{ "FROM_STRING_DC_LIMIT", BI::FROM_STRING_DC_LIMIT, from_str, 4, 2000 }
+			}
+		};
+
+		std::map<std::string, unsigned int> found;
+		for (auto & group : groups) {
+			for (auto & p : group)
+				p.var = DISABLED;
+			size_t prev = 0;
+			for (auto & p : group) {
+				size_t from = std::max(prev, p.from), to = std::max(from, p.to * 32 / SIZE);
+				p.var = (unsigned int)tune_param(p, from, to);
+				found[p.name] = p.var;
+				//the next algorithm of the group is scanned above the last found crossover
+				if (p.var != NEVER)
+					prev = p.var;
+			}
+		}
+
+		auto res = current<SIZE>();
+		for (auto & t : res)
+			t.second = found[t.first];
+		return res;
+	}
+
+	void write_header(std::ostream & s, const std::map<int, ThresholdList> & sizes) {
+		s << "#pragma once\n\n";
+		s << "#include <climits>\n\n";
+		s << "//Crossover sizes of BigInt_t algorithms in limbs of SIZE bits.\n";
+		s << "//Generated by the Tune program (AlgNT_1/Tune), rerun it on the target machine instead of editing.\n";
+		s << "namespace BigIntUtility {\n\n";
+		s << "\ttemplate<int SIZE> struct thresholds {};\n";
+		for (auto & sz : sizes) {
+			s << "\n\ttemplate<> struct thresholds<" << sz.first << "> {\n";
+			for (auto & t : sz.second) {
+				s << "\t\tstatic const unsigned int " << t.first << " = ";
+				if (t.second == NEVER)
+					s << "UINT_MAX; //never wins in the scanned range\n";
+				else
+					s << t.second << ";\n";
+			}
+			s << "\t};\n";
+		}
+		s << "}\n";
+	}
+}
+
+int main(int argc, char ** argv) {
+	std::string out = "../AlgNT_1/BigIntThresholds.h";
+	std::vector<int> to_tune;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "-o" && i + 1 < argc)
+			out = argv[++i];
+		else
+			to_tune.push_back(std::atoi(argv[i]));
+	}
+	if (to_tune.empty())
+		to_tune = { 8, 16, 32, 64 };
+	auto wanted = [&](int size) {
+		return std::find(to_tune.begin(), to_tune.end(), size) != to_tune.end();
+	};
+
+	std::map<int, Tune::ThresholdList> sizes = {
+		{ 8, wanted(8) ? Tune::tune<8>() : Tune::current<8>() },
+		{ 16, wanted(16) ? Tune::tune<16>() : Tune::current<16>() },
+		{ 32, wanted(32) ? Tune::tune<32>() : Tune::current<32>() },
+		{ 64, Tune::current<64>() }
+	};
+	//64-bit limbs need 128-bit double limbs
+#if defined(__SIZEOF_INT128__)
+	if (wanted(64))
+		sizes[64] = Tune::tune<64>();
+#endif
+
+	std::ofstream of(out);
+	if (!of) {
+		std::cerr << "Unable to open " << out << "\n";
+		return 1;
+	}
+	Tune::write_header(of, sizes);
+	std::cout << "Thresholds are written to " << out << "\n";
+	return 0;
+}
@@ -84,7 +84,7 @@ Euclid::BI Euclid::gcd_ext(BI a, BI b, BI & u, BI & v, GCDCalcMethod method)
 }
 
 void Euclid::_gcd1_ext(BI & a, BI & b, BI & u, BI & v, BI & res){
-	BI r, q, u0, v0, ut, vt;
+	BI r, q, u0, v0;
 	v = u0 = 0;
 	u = v0 = 1;
 	
@@ -94,13 +94,12 @@ void Euclid::_gcd1_ext(BI & a, BI & b, BI & u, BI & v, BI & res){
 		a = b;
 		b = r;
 
-		ut = u0;
-		u0 = u - u0*q;
-		u = ut;
+		//(u, u0) = (u0, u - u0*q)
+		submul(u, u0, q);
+		std::swap(u, u0);
 
-		vt = v0;
-		v0 = v - v0*q;
-		v = vt;
+		submul(v, v0, q);
+		std::swap(v, v0);
 	}
 	res = a;
 	return;
@@ -204,5 +203,5 @@ void Euclid::_gcd2_ext_pre(BI & a, BI & b, BI & u, BI & v, BI & res){
 
 Euclid::BI Euclid::lcm(const BI & a, const BI & b, GCDCalcMethod method)
 {
-	return (a.isNull() && b.isNull()) ? 0 :((a / gcd(a, b, method)) * b).abs();
+	return (a.isNull() && b.isNull()) ? BI(0) : (BI::divexact(a, gcd(a, b, method)) * b).abs();
 }
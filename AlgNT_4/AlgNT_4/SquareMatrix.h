@@ -2,6 +2,14 @@
 #include <algorithm>
 #include "MatrixException.h"
 
+namespace SquareMatrixUtility {
+	//r += a * b for the types without their own addmul. BigInt_t has a fused one, it is found by ADL
+	template<class T>
+	inline T & addmul(T & r, const T & a, const T & b) {
+		return r += a * b;
+	}
+}
+
 template<class T>
 class SquareMatrix {
 	T * data;
@@ -61,9 +69,10 @@ void SquareMatrix<T>::add_row(size_t i, size_t j) {
 
 template<class T>
 void SquareMatrix<T>::add_row_multiplied(size_t i, size_t j, const T & a) {
+	using SquareMatrixUtility::addmul;
 	T * pi = (*this)[i], *pj = (*this)[j];
 	for (size_t k = 0; k < n; ++k) {
-		pi[k] += pj[k] * a;
+		addmul(pi[k], pj[k], a);
 	}
 }
 
@@ -147,7 +147,7 @@ AllSolsResult find_all_solutions(
 
 	auto _a = a;
 	for (auto & el : _a) {
-		el /= d;
+		el = Euclid::BI::divexact(el, d);
 	}
 
 	solve_Diophantine_eq(_a, 1, x);
@@ -265,14 +265,14 @@ void task_all(std::vector<Euclid::BI> & a, Euclid::BI & b, std::ostream & out =
 				out << "k_" << j;
 			}
 			out << "\n";
-			res += a[i - 1] * x[i - 1];
+			addmul(res, a[i - 1], x[i - 1]);
 		}
 
 		//check coefficients
 		for (size_t j = 0; j < n - 1; ++j) {
 			Euclid::BI sum;
 			for (size_t i = 0; i < n; ++i) {
-				sum += cf[i][j] * a[i];
+				addmul(sum, cf[i][j], a[i]);
 			}
 			allSolsOK = allSolsOK && sum == Euclid::BI(0);
 		}
@@ -309,7 +309,7 @@ void task_part(std::vector<Euclid::BI> & a, Euclid::BI & b, std::ostream & out =
 	else {
 		for (size_t i = 1; i <= n; ++i) {
 			out << "x_" << i << " = " << x[i - 1] << "\n";
-			res += a[i - 1] * x[i - 1];
+			addmul(res, a[i - 1], x[i - 1]);
 		}
 
 		out << "(k_i are any integers)\n";